@@ -0,0 +1,99 @@
+#ifndef BLOCKS_H
+#define BLOCKS_H
+
+#include "cube.h"
+
+// Compile-time block registry: everything the mesher, collision and
+// raycasting need to know about a block type, indexed by BlockType.
+// Rows must stay in enum order.
+
+// A rectangle in the 16x16-tile texture atlas (UV space).
+struct UVRect {
+    float u0, v0, u1, v1;
+};
+
+// Which draw pass a block's faces go in. Opaque faces are drawn first
+// without blending or alpha testing, cutout faces (fully opaque or fully
+// clear texels) with alpha testing, and translucent faces last, blended
+// and sorted back to front. Indexes the layers of a section mesh.
+enum RenderLayer {
+    LAYER_OPAQUE,
+    LAYER_CUTOUT,
+    LAYER_TRANSLUCENT,
+    RENDER_LAYER_COUNT
+};
+
+struct BlockInfo {
+    UVRect top, side, bottom;
+    bool collision;    // the player can't walk through it
+    bool targetable;   // the crosshair raycast stops on it
+    bool occludes;     // hides the faces of neighbouring blocks that touch it
+    RenderLayer layer;
+};
+
+static constexpr float ATLAS_TILE = 1.0f / 16.0f;
+
+// UV rect of atlas tile (tx, ty), with (0, 0) at the bottom-left.
+constexpr UVRect tileRect(float tx, float ty) {
+    return UVRect{ tx * ATLAS_TILE, ty * ATLAS_TILE, (tx + 1) * ATLAS_TILE, (ty + 1) * ATLAS_TILE };
+}
+
+// Water is sampled slightly inside its tile so neighbouring tiles don't
+// bleed into the blended surface.
+constexpr UVRect insetTileRect(float tx, float ty, float inset) {
+    return UVRect{ (tx + inset) * ATLAS_TILE, (ty + inset) * ATLAS_TILE,
+                   (tx + 1 - inset) * ATLAS_TILE, (ty + 1 - inset) * ATLAS_TILE };
+}
+
+// Shorthands for the common row shapes.
+#define BLOCK_OPAQUE(tx, ty) \
+    { tileRect(tx, ty), tileRect(tx, ty), tileRect(tx, ty), true, true, true, LAYER_OPAQUE }
+#define BLOCK_OPAQUE_3(topX, topY, sideX, sideY, bottomX, bottomY) \
+    { tileRect(topX, topY), tileRect(sideX, sideY), tileRect(bottomX, bottomY), true, true, true, LAYER_OPAQUE }
+
+static constexpr BlockInfo BLOCK_INFO[] = {
+    /* BLOCK_GRASS           */ BLOCK_OPAQUE_3(0, 15, 3, 15, 2, 15),
+    /* BLOCK_DIRT            */ BLOCK_OPAQUE(2, 15),
+    /* BLOCK_STONE           */ BLOCK_OPAQUE(1, 15),
+    /* BLOCK_SAND            */ BLOCK_OPAQUE(2, 14),
+    /* BLOCK_BEDROCK         */ BLOCK_OPAQUE(1, 14),
+    /* BLOCK_TREE_LOG        */ BLOCK_OPAQUE_3(5, 14, 4, 14, 5, 14),
+    /* BLOCK_LEAVES          */ { tileRect(4, 12), tileRect(4, 12), tileRect(4, 12), true, true, true, LAYER_CUTOUT },
+    /* BLOCK_WATER           */ { insetTileRect(13, 3, 0.01f), insetTileRect(13, 3, 0.01f),
+                                  insetTileRect(13, 3, 0.01f), false, false, false,
+                                  LAYER_TRANSLUCENT },
+    /* BLOCK_WOODEN_PLANKS   */ BLOCK_OPAQUE(4, 15),
+    /* BLOCK_COBBLESTONE     */ BLOCK_OPAQUE(0, 14),
+    /* BLOCK_GRAVEL          */ BLOCK_OPAQUE(3, 14),
+    /* BLOCK_BRICKS          */ BLOCK_OPAQUE(7, 15),
+    /* BLOCK_GLASS           */ { tileRect(1, 12), tileRect(1, 12), tileRect(1, 12), true, true, true, LAYER_CUTOUT },
+    /* BLOCK_SPONGE          */ BLOCK_OPAQUE(0, 12),
+    /* BLOCK_WOOL_WHITE      */ BLOCK_OPAQUE(1, 8),
+    /* BLOCK_WOOL_RED        */ BLOCK_OPAQUE(1, 7),
+    /* BLOCK_WOOL_BLACK      */ BLOCK_OPAQUE(1, 8),
+    /* BLOCK_WOOL_GREY       */ BLOCK_OPAQUE(2, 8),
+    /* BLOCK_WOOL_PINK       */ BLOCK_OPAQUE(2, 7),
+    /* BLOCK_WOOL_LIME_GREEN */ BLOCK_OPAQUE(2, 6),
+    /* BLOCK_WOOL_GREEN      */ BLOCK_OPAQUE(1, 6),
+    /* BLOCK_WOOL_BROWN      */ BLOCK_OPAQUE(1, 5),
+    /* BLOCK_WOOL_YELLOW     */ BLOCK_OPAQUE(2, 5),
+    /* BLOCK_WOOL_LIGHT_BLUE */ BLOCK_OPAQUE(2, 4),
+    /* BLOCK_WOOL_BLUE       */ BLOCK_OPAQUE(1, 4),
+    /* BLOCK_WOOL_PURPLE     */ BLOCK_OPAQUE(1, 3),
+    /* BLOCK_WOOL_VIOLET     */ BLOCK_OPAQUE(2, 3),
+    /* BLOCK_WOOL_TURQUOISE  */ BLOCK_OPAQUE(1, 2),
+    /* BLOCK_WOOL_ORANGE     */ BLOCK_OPAQUE(2, 2),
+};
+
+#undef BLOCK_OPAQUE
+#undef BLOCK_OPAQUE_3
+
+static_assert(sizeof(BLOCK_INFO) / sizeof(BLOCK_INFO[0]) == BLOCK_COUNT,
+              "BLOCK_INFO needs one row per BlockType");
+
+// Registry row for a real block (not BLOCK_NONE / removed markers).
+inline const BlockInfo& blockInfo(BlockType t) {
+    return BLOCK_INFO[t];
+}
+
+#endif // BLOCKS_H
@@ -0,0 +1,62 @@
+#include "columnpack.h"
+#include <algorithm>
+
+static const int CELLS = 18 * 18;
+
+// Encodes the CELLS values read through get(i) as (run, value) pairs.
+template <typename Get>
+static void encodeRuns(std::vector<uint8_t> &runs, Get get) {
+    runs.clear();
+    int i = 0;
+    while(i < CELLS) {
+        uint8_t value = get(i);
+        int run = 1;
+        while(i + run < CELLS && run < 255 && get(i + run) == value)
+            run++;
+        runs.push_back((uint8_t)run);
+        runs.push_back(value);
+        i += run;
+    }
+    runs.shrink_to_fit();
+}
+
+bool packChunkColumns(const ChunkColumns &cols, PackedColumns &out)
+{
+    const int *heights = &cols.heights[0][0];
+    const Biome *biomes = &cols.biomes[0][0];
+    int lo = *std::min_element(heights, heights + CELLS);
+    int hi = *std::max_element(heights, heights + CELLS);
+    if(hi - lo > 255)
+        return false;
+    out.cx = cols.cx;
+    out.cz = cols.cz;
+    out.naturalTop = cols.naturalTop;
+    out.baseHeight = lo;
+    encodeRuns(out.heightRuns, [&](int i) { return (uint8_t)(heights[i] - lo); });
+    encodeRuns(out.biomeRuns, [&](int i) { return (uint8_t)biomes[i]; });
+    return true;
+}
+
+void unpackChunkColumns(const PackedColumns &packed, ChunkColumns &out)
+{
+    out.cx = packed.cx;
+    out.cz = packed.cz;
+    out.naturalTop = packed.naturalTop;
+    int *heights = &out.heights[0][0];
+    Biome *biomes = &out.biomes[0][0];
+    for(size_t r = 0, i = 0; r < packed.heightRuns.size(); r += 2) {
+        int h = packed.baseHeight + packed.heightRuns[r + 1];
+        for(int n = 0; n < packed.heightRuns[r]; n++)
+            heights[i++] = h;
+    }
+    for(size_t r = 0, i = 0; r < packed.biomeRuns.size(); r += 2) {
+        Biome b = (Biome)packed.biomeRuns[r + 1];
+        for(int n = 0; n < packed.biomeRuns[r]; n++)
+            biomes[i++] = b;
+    }
+}
+
+size_t packedColumnsBytes(const PackedColumns &packed)
+{
+    return sizeof(packed) + packed.heightRuns.capacity() + packed.biomeRuns.capacity();
+}
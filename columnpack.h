@@ -0,0 +1,32 @@
+#ifndef COLUMNPACK_H
+#define COLUMNPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mesher.h"
+
+// Run-length encoded ChunkColumns, for loaded chunks far from the player
+// that only need their columns again if they get remeshed. Heights vary
+// slowly and most chunks lie in a single biome, so the 18x18 grids shrink
+// from 2.6 KiB to a few hundred bytes (one run for a single-biome chunk).
+//
+// Both grids are encoded row by row ([z][x], the ChunkColumns layout) as
+// (run length, value) byte pairs; heights are stored relative to the
+// lowest column.
+struct PackedColumns {
+    int cx, cz;
+    int naturalTop;
+    int baseHeight;
+    std::vector<uint8_t> heightRuns;
+    std::vector<uint8_t> biomeRuns;
+};
+
+// False, leaving out untouched, if the heights span more than 255 blocks.
+bool packChunkColumns(const ChunkColumns &cols, PackedColumns &out);
+void unpackChunkColumns(const PackedColumns &packed, ChunkColumns &out);
+
+// Heap and inline bytes held by a packed chunk.
+size_t packedColumnsBytes(const PackedColumns &packed);
+
+#endif // COLUMNPACK_H
@@ -0,0 +1,69 @@
+#ifndef COORDS_H
+#define COORDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <utility>
+
+// The original hashes for coordinate pairs and tuples. They map
+// neighbouring coordinates to neighbouring or identical buckets, so the
+// game keys its maps with packed keys (below) instead; they remain only
+// for microbench's comparisons.
+
+// Custom hash for std::pair<int, int>
+struct PairHash {
+    std::size_t operator()(const std::pair<int,int>& p) const {
+        return std::hash<int>()(p.first) ^ (std::hash<int>()(p.second) << 1);
+    }
+};
+
+// Custom hash for std::tuple<int, int, int>
+struct TupleHash {
+    std::size_t operator()(const std::tuple<int,int,int>& t) const {
+        std::size_t h1 = std::hash<int>()(std::get<0>(t));
+        std::size_t h2 = std::hash<int>()(std::get<1>(t));
+        std::size_t h3 = std::hash<int>()(std::get<2>(t));
+        return h1 ^ (h2 << 1) ^ (h3 << 2);
+    }
+};
+
+// Packed 64-bit keys for FlatMap (flatmap.h). Block keys hold x and z in
+// 26 bits each (+-33M blocks) and y in 12 bits (-2048..2047); section keys
+// (cx, sy, cz) use the same layout. Chunk keys hold cx and cz whole.
+inline uint64_t packBlockKey(int x, int y, int z) {
+    return ((uint64_t)(uint32_t)x & 0x3FFFFFF) << 38 |
+           ((uint64_t)(uint32_t)y & 0xFFF) << 26 |
+           ((uint64_t)(uint32_t)z & 0x3FFFFFF);
+}
+
+inline void unpackBlockKey(uint64_t key, int &x, int &y, int &z) {
+    // Shift each field to the top, then arithmetic-shift back to sign-extend.
+    x = (int)((int64_t)key >> 38);
+    y = (int)((int64_t)(key << 26) >> 52);
+    z = (int)((int64_t)(key << 38) >> 38);
+}
+
+inline uint64_t packChunkKey(int cx, int cz) {
+    return (uint64_t)(uint32_t)cx << 32 | (uint32_t)cz;
+}
+
+inline void unpackChunkKey(uint64_t key, int &cx, int &cz) {
+    cx = (int)(uint32_t)(key >> 32);
+    cz = (int)(uint32_t)key;
+}
+
+// Chunk containing the given block column (floor division by 16).
+inline void getChunkCoords(int bx, int bz, int &cx, int &cz) {
+    cx = bx / 16; if(bx < 0 && bx % 16 != 0) cx--;
+    cz = bz / 16; if(bz < 0 && bz % 16 != 0) cz--;
+}
+
+// Vertical section holding block height by (floor division by 16).
+inline int getSectionY(int by) {
+    int sy = by / 16; if(by < 0 && by % 16 != 0) sy--;
+    return sy;
+}
+
+#endif // COORDS_H
@@ -35,7 +35,8 @@ enum BlockType {
     BLOCK_WOOL_PURPLE,
     BLOCK_WOOL_VIOLET,
     BLOCK_WOOL_TURQUOISE,
-    BLOCK_WOOL_ORANGE
+    BLOCK_WOOL_ORANGE,
+    BLOCK_COUNT
 };
 
 // Adds a cube at position (x,y,z) with textures chosen based on the block type.
@@ -44,5 +45,32 @@ enum BlockType {
 // are added.
 void addCube(std::vector<float>& vertices, float x, float y, float z, BlockType blockType, bool cullFaces = true);
 
+// Cube faces, named by the direction they face.
+enum CubeFace {
+    FACE_POS_Z, // front
+    FACE_NEG_Z, // back
+    FACE_NEG_X, // left
+    FACE_POS_X, // right
+    FACE_POS_Y, // top
+    FACE_NEG_Y  // bottom
+};
+
+// Floats per face: two triangles of 3 position + 2 UV floats per vertex.
+static const int FACE_FLOATS = 6 * 5;
+
+// Adds a single face (two triangles, same layout as addCube) of the block at
+// (x,y,z).
+void addCubeFace(std::vector<float>& vertices, float x, float y, float z, BlockType blockType, CubeFace face);
+
+// Writes the same face as addCubeFace to out, which must have room for
+// FACE_FLOATS floats. Used by the chunk mesher, which does its own face
+// culling and sizes its output up front.
+void writeCubeFace(float* out, float x, float y, float z, BlockType blockType, CubeFace face);
+
+// Same as writeCubeFace for the box (x0,y0,z0)-(x1,y1,z1), with the block's
+// texture stretched over the whole face. Used for level-of-detail meshes.
+void writeBoxFace(float* out, float x0, float y0, float z0, float x1, float y1, float z1,
+                  BlockType blockType, CubeFace face);
+
 #endif // CUBE_H
 
@@ -0,0 +1,186 @@
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Open-addressing hash map from packed 64-bit coordinates (see
+// packBlockKey/packChunkKey in coords.h) to V. Entries live in one flat
+// array probed linearly, next to a byte per slot holding 7 bits of the
+// hash, so a lookup usually touches one or two cache lines and inserting
+// never allocates a node. Erasing shifts the following entries back
+// instead of leaving tombstones.
+//
+// The interface follows std::unordered_map closely enough for the world
+// code: find/end, operator[], insert, erase by key, size, clear and
+// range-for over std::pair<uint64_t, V> entries. Unlike unordered_map,
+// inserting or erasing moves entries, so iterators and references to
+// values are only valid until the next insert or erase.
+
+// Mixes every bit of a packed key into every bit of the hash (the
+// splitmix64 / MurmurHash3 finaliser). Neighbouring coordinates differ in
+// a few low bits, which the old TupleHash/PairHash mapped to neighbouring
+// or identical buckets.
+inline uint64_t mixCoordKey(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+template <typename V>
+class FlatMap {
+public:
+    typedef std::pair<uint64_t, V> value_type;
+
+    class iterator {
+    public:
+        iterator(FlatMap *map, size_t slot) : m_map(map), m_slot(slot) { skipEmpty(); }
+        value_type &operator*() const { return m_map->m_slots[m_slot]; }
+        value_type *operator->() const { return &m_map->m_slots[m_slot]; }
+        iterator &operator++() { m_slot++; skipEmpty(); return *this; }
+        bool operator==(const iterator &o) const { return m_slot == o.m_slot; }
+        bool operator!=(const iterator &o) const { return m_slot != o.m_slot; }
+    private:
+        void skipEmpty() {
+            while(m_slot < m_map->m_ctrl.size() && !m_map->m_ctrl[m_slot])
+                m_slot++;
+        }
+        FlatMap *m_map;
+        size_t m_slot;
+    };
+
+    FlatMap() : m_size(0) {}
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, m_ctrl.size()); }
+
+    iterator find(uint64_t key) {
+        size_t slot;
+        return locate(key, slot) ? iterator(this, slot) : end();
+    }
+
+    // Inserts entry unless its key is present. Returns the entry with that
+    // key and whether it was inserted, like unordered_map::insert.
+    std::pair<iterator, bool> insert(const value_type &entry) {
+        size_t slot;
+        if(locate(entry.first, slot))
+            return std::make_pair(iterator(this, slot), false);
+        slot = claim(entry.first);
+        m_slots[slot].second = entry.second;
+        return std::make_pair(iterator(this, slot), true);
+    }
+
+    V &operator[](uint64_t key) {
+        size_t slot;
+        if(!locate(key, slot))
+            slot = claim(key);
+        return m_slots[slot].second;
+    }
+
+    size_t erase(uint64_t key) {
+        size_t slot;
+        if(!locate(key, slot))
+            return 0;
+        // Backward-shift deletion: pull later entries of the probe run
+        // into the hole while that keeps them at or after their home slot.
+        size_t mask = m_ctrl.size() - 1;
+        size_t hole = slot;
+        for(size_t next = (hole + 1) & mask; m_ctrl[next]; next = (next + 1) & mask) {
+            size_t home = mixCoordKey(m_slots[next].first) & mask;
+            if(((next - home) & mask) >= ((next - hole) & mask)) {
+                m_ctrl[hole] = m_ctrl[next];
+                m_slots[hole] = std::move(m_slots[next]);
+                hole = next;
+            }
+        }
+        m_ctrl[hole] = 0;
+        m_slots[hole] = value_type();
+        m_size--;
+        return 1;
+    }
+
+    void clear() {
+        m_ctrl.clear();
+        m_slots.clear();
+        m_size = 0;
+    }
+
+    // Makes room for n entries without rehashing.
+    void reserve(size_t n) {
+        size_t capacity = MIN_CAPACITY;
+        while(capacity * MAX_LOAD_NUM < n * MAX_LOAD_DEN)
+            capacity *= 2;
+        if(capacity > m_ctrl.size())
+            rehash(capacity);
+    }
+
+private:
+    // Grown at 3/4 full, where linear probing with a well-mixed hash
+    // still finds or rules out a key within a few slots.
+    static const size_t MIN_CAPACITY = 16;
+    static const size_t MAX_LOAD_NUM = 3;
+    static const size_t MAX_LOAD_DEN = 4;
+
+    static uint8_t tag(uint64_t hash) { return (uint8_t)(0x80 | (hash >> 57)); }
+
+    bool locate(uint64_t key, size_t &slot) const {
+        if(m_ctrl.empty())
+            return false;
+        uint64_t hash = mixCoordKey(key);
+        uint8_t t = tag(hash);
+        size_t mask = m_ctrl.size() - 1;
+        for(size_t i = hash & mask; m_ctrl[i]; i = (i + 1) & mask) {
+            if(m_ctrl[i] == t && m_slots[i].first == key) {
+                slot = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Takes the first free slot for a key known to be absent, growing the
+    // table first if needed.
+    size_t claim(uint64_t key) {
+        if((m_size + 1) * MAX_LOAD_DEN > m_ctrl.size() * MAX_LOAD_NUM)
+            rehash(m_ctrl.empty() ? MIN_CAPACITY : m_ctrl.size() * 2);
+        uint64_t hash = mixCoordKey(key);
+        size_t mask = m_ctrl.size() - 1;
+        size_t i = hash & mask;
+        while(m_ctrl[i])
+            i = (i + 1) & mask;
+        m_ctrl[i] = tag(hash);
+        m_slots[i].first = key;
+        m_size++;
+        return i;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<uint8_t> oldCtrl(capacity, 0);
+        std::vector<value_type> oldSlots(capacity);
+        oldCtrl.swap(m_ctrl);
+        oldSlots.swap(m_slots);
+        size_t mask = capacity - 1;
+        for(size_t s = 0; s < oldCtrl.size(); s++) {
+            if(!oldCtrl[s]) continue;
+            size_t i = mixCoordKey(oldSlots[s].first) & mask;
+            while(m_ctrl[i])
+                i = (i + 1) & mask;
+            m_ctrl[i] = oldCtrl[s];
+            m_slots[i] = std::move(oldSlots[s]);
+        }
+    }
+
+    std::vector<uint8_t> m_ctrl;      // 0 = empty, else 0x80 | top hash bits
+    std::vector<value_type> m_slots;
+    size_t m_size;
+};
+
+#endif // FLATMAP_H
@@ -0,0 +1,142 @@
+#include "font.h"
+#include "ui.h"
+#include <GL/glew.h>
+#include <cctype>
+#include <vector>
+
+static const int GLYPH_W = 5, GLYPH_H = 7;
+// Each glyph sits in a CELL_W x CELL_H texture cell; the extra column and
+// row double as spacing between characters and lines.
+static const int CELL_W = GLYPH_W + 1, CELL_H = GLYPH_H + 2;
+static const int ATLAS_COLUMNS = 16;
+
+struct Glyph {
+    char c;
+    const char* rows[GLYPH_H]; // top row first, '#' = set
+};
+
+static const Glyph s_glyphs[] = {
+    { ' ', { ".....", ".....", ".....", ".....", ".....", ".....", "....." } },
+    { '0', { ".###.", "#...#", "#..##", "#.#.#", "##..#", "#...#", ".###." } },
+    { '1', { "..#..", ".##..", "..#..", "..#..", "..#..", "..#..", ".###." } },
+    { '2', { ".###.", "#...#", "....#", "...#.", "..#..", ".#...", "#####" } },
+    { '3', { "#####", "...#.", "..#..", "...#.", "....#", "#...#", ".###." } },
+    { '4', { "...#.", "..##.", ".#.#.", "#..#.", "#####", "...#.", "...#." } },
+    { '5', { "#####", "#....", "####.", "....#", "....#", "#...#", ".###." } },
+    { '6', { "..##.", ".#...", "#....", "####.", "#...#", "#...#", ".###." } },
+    { '7', { "#####", "....#", "...#.", "..#..", ".#...", ".#...", ".#..." } },
+    { '8', { ".###.", "#...#", "#...#", ".###.", "#...#", "#...#", ".###." } },
+    { '9', { ".###.", "#...#", "#...#", ".####", "....#", "...#.", ".##.." } },
+    { 'A', { ".###.", "#...#", "#...#", "#####", "#...#", "#...#", "#...#" } },
+    { 'B', { "####.", "#...#", "#...#", "####.", "#...#", "#...#", "####." } },
+    { 'C', { ".###.", "#...#", "#....", "#....", "#....", "#...#", ".###." } },
+    { 'D', { "###..", "#..#.", "#...#", "#...#", "#...#", "#..#.", "###.." } },
+    { 'E', { "#####", "#....", "#....", "####.", "#....", "#....", "#####" } },
+    { 'F', { "#####", "#....", "#....", "####.", "#....", "#....", "#...." } },
+    { 'G', { ".###.", "#...#", "#....", "#.###", "#...#", "#...#", ".####" } },
+    { 'H', { "#...#", "#...#", "#...#", "#####", "#...#", "#...#", "#...#" } },
+    { 'I', { ".###.", "..#..", "..#..", "..#..", "..#..", "..#..", ".###." } },
+    { 'J', { "..###", "...#.", "...#.", "...#.", "...#.", "#..#.", ".##.." } },
+    { 'K', { "#...#", "#..#.", "#.#..", "##...", "#.#..", "#..#.", "#...#" } },
+    { 'L', { "#....", "#....", "#....", "#....", "#....", "#....", "#####" } },
+    { 'M', { "#...#", "##.##", "#.#.#", "#.#.#", "#...#", "#...#", "#...#" } },
+    { 'N', { "#...#", "#...#", "##..#", "#.#.#", "#..##", "#...#", "#...#" } },
+    { 'O', { ".###.", "#...#", "#...#", "#...#", "#...#", "#...#", ".###." } },
+    { 'P', { "####.", "#...#", "#...#", "####.", "#....", "#....", "#...." } },
+    { 'Q', { ".###.", "#...#", "#...#", "#...#", "#.#.#", "#..#.", ".##.#" } },
+    { 'R', { "####.", "#...#", "#...#", "####.", "#.#..", "#..#.", "#...#" } },
+    { 'S', { ".####", "#....", "#....", ".###.", "....#", "....#", "####." } },
+    { 'T', { "#####", "..#..", "..#..", "..#..", "..#..", "..#..", "..#.." } },
+    { 'U', { "#...#", "#...#", "#...#", "#...#", "#...#", "#...#", ".###." } },
+    { 'V', { "#...#", "#...#", "#...#", "#...#", "#...#", ".#.#.", "..#.." } },
+    { 'W', { "#...#", "#...#", "#...#", "#.#.#", "#.#.#", "#.#.#", ".#.#." } },
+    { 'X', { "#...#", "#...#", ".#.#.", "..#..", ".#.#.", "#...#", "#...#" } },
+    { 'Y', { "#...#", "#...#", ".#.#.", "..#..", "..#..", "..#..", "..#.." } },
+    { 'Z', { "#####", "....#", "...#.", "..#..", ".#...", "#....", "#####" } },
+    { '.', { ".....", ".....", ".....", ".....", ".....", ".##..", ".##.." } },
+    { ',', { ".....", ".....", ".....", ".....", ".##..", "..#..", ".#..." } },
+    { ':', { ".....", ".##..", ".##..", ".....", ".##..", ".##..", "....." } },
+    { '/', { ".....", "....#", "...#.", "..#..", ".#...", "#....", "....." } },
+    { '%', { "##...", "##..#", "...#.", "..#..", ".#...", "#..##", "...##" } },
+    { '-', { ".....", ".....", ".....", "#####", ".....", ".....", "....." } },
+    { '+', { ".....", "..#..", "..#..", "#####", "..#..", "..#..", "....." } },
+    { '=', { ".....", ".....", "#####", ".....", "#####", ".....", "....." } },
+    { '(', { "...#.", "..#..", ".#...", ".#...", ".#...", "..#..", "...#." } },
+    { ')', { ".#...", "..#..", "...#.", "...#.", "...#.", "..#..", ".#..." } },
+    { '_', { ".....", ".....", ".....", ".....", ".....", ".....", "#####" } },
+    { '?', { ".###.", "#...#", "....#", "...#.", "..#..", ".....", "..#.." } },
+};
+
+static const int GLYPH_COUNT = sizeof(s_glyphs) / sizeof(s_glyphs[0]);
+
+static GLuint s_fontTex = 0;
+static int    s_atlasW = 0, s_atlasH = 0;
+static int    s_glyphIndex[128]; // ASCII -> index into s_glyphs, or -1
+
+void fontInit()
+{
+    int atlasRows = (GLYPH_COUNT + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    s_atlasW = ATLAS_COLUMNS * CELL_W;
+    s_atlasH = atlasRows * CELL_H;
+
+    // White texels with coverage in alpha, so the UI colour tints the text.
+    std::vector<unsigned char> pixels(s_atlasW * s_atlasH * 4, 0);
+    for(int i = 0; i < 128; i++)
+        s_glyphIndex[i] = -1;
+    for(int g = 0; g < GLYPH_COUNT; g++) {
+        s_glyphIndex[(int)s_glyphs[g].c] = g;
+        int cellX = (g % ATLAS_COLUMNS) * CELL_W;
+        int cellY = (g / ATLAS_COLUMNS) * CELL_H;
+        for(int row = 0; row < GLYPH_H; row++) {
+            // Texture rows run bottom-up; glyph rows are listed top-down.
+            int py = cellY + (GLYPH_H - 1 - row);
+            for(int col = 0; col < GLYPH_W; col++) {
+                unsigned char* p = &pixels[((py * s_atlasW) + cellX + col) * 4];
+                p[0] = p[1] = p[2] = 255;
+                p[3] = (s_glyphs[g].rows[row][col] == '#') ? 255 : 0;
+            }
+        }
+    }
+
+    glGenTextures(1, &s_fontTex);
+    glBindTexture(GL_TEXTURE_2D, s_fontTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, s_atlasW, s_atlasH, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void fontShutdown()
+{
+    glDeleteTextures(1, &s_fontTex);
+    s_fontTex = 0;
+}
+
+float fontDrawText(float x, float y, const char* text, float scale,
+                   float r, float g, float b, float a)
+{
+    float penX = x;
+    for(const char* c = text; *c; c++) {
+        int ch = toupper((unsigned char)*c);
+        int idx = (ch < 128) ? s_glyphIndex[ch] : -1;
+        if(idx < 0) idx = s_glyphIndex[(int)'?'];
+        if(s_glyphs[idx].c != ' ') {
+            float u0 = (float)((idx % ATLAS_COLUMNS) * CELL_W) / s_atlasW;
+            float v0 = (float)((idx / ATLAS_COLUMNS) * CELL_H) / s_atlasH;
+            float u1 = u0 + (float)GLYPH_W / s_atlasW;
+            float v1 = v0 + (float)GLYPH_H / s_atlasH;
+            uiTexturedRect(penX, y, GLYPH_W * scale, GLYPH_H * scale, s_fontTex,
+                           u0, v0, u1, v1, r, g, b, a);
+        }
+        penX += CELL_W * scale;
+    }
+    return penX - x;
+}
+
+float fontLineHeight(float scale)
+{
+    return CELL_H * scale;
+}
@@ -0,0 +1,21 @@
+#ifndef FONT_H
+#define FONT_H
+
+// Minimal 5x7 bitmap font drawn through the UI batcher.
+// Covers digits, A-Z (lowercase is drawn as uppercase) and basic
+// punctuation; anything else is drawn as '?'.
+
+// Builds the glyph texture. Needs a GL context.
+void fontInit();
+void fontShutdown();
+
+// Queues text between uiBegin() and uiFlush(). (x, y) is the bottom-left
+// corner of the first glyph in pixels; scale is an integer pixel multiplier
+// for crisp output. Returns the width of the text in pixels.
+float fontDrawText(float x, float y, const char* text, float scale,
+                   float r = 1.0f, float g = 1.0f, float b = 1.0f, float a = 1.0f);
+
+// Height of one line of text, including spacing, at the given scale.
+float fontLineHeight(float scale);
+
+#endif // FONT_H
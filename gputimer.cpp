@@ -0,0 +1,132 @@
+#include "gputimer.h"
+#include "profiler.h"
+#include "ui.h"
+#include <GL/glew.h>
+
+static const int QUERY_SETS = 2;
+
+struct PassTimer {
+    GLuint   queries[QUERY_SETS];
+    GLuint   sampleQueries[QUERY_SETS];
+    bool     issued[QUERY_SETS];
+    uint64_t cpuStartNs[QUERY_SETS]; // when the pass was submitted, for the trace
+    float    smoothedMs;
+    unsigned long long samples;
+};
+
+static PassTimer s_passes[GPU_PASS_COUNT];
+static int  s_frameSet = 0;
+static bool s_initialized = false;
+
+static const char* s_passNames[GPU_PASS_COUNT] = {
+    "GPU world pass",
+    "GPU held item pass",
+    "GPU UI pass"
+};
+
+void gpuTimersInit()
+{
+    for(int p = 0; p < GPU_PASS_COUNT; p++) {
+        glGenQueries(QUERY_SETS, s_passes[p].queries);
+        glGenQueries(QUERY_SETS, s_passes[p].sampleQueries);
+        for(int i = 0; i < QUERY_SETS; i++) {
+            s_passes[p].issued[i] = false;
+            s_passes[p].cpuStartNs[i] = 0;
+        }
+        s_passes[p].smoothedMs = 0.0f;
+        s_passes[p].samples = 0;
+    }
+    s_initialized = true;
+}
+
+void gpuTimersShutdown()
+{
+    if(!s_initialized) return;
+    for(int p = 0; p < GPU_PASS_COUNT; p++) {
+        glDeleteQueries(QUERY_SETS, s_passes[p].queries);
+        glDeleteQueries(QUERY_SETS, s_passes[p].sampleQueries);
+    }
+    s_initialized = false;
+}
+
+void gpuTimerBegin(GpuPass pass)
+{
+    if(!s_initialized) return;
+    PassTimer &t = s_passes[pass];
+    t.cpuStartNs[s_frameSet] = profilerNowNs();
+    glBeginQuery(GL_TIME_ELAPSED, t.queries[s_frameSet]);
+    glBeginQuery(GL_SAMPLES_PASSED, t.sampleQueries[s_frameSet]);
+}
+
+void gpuTimerEnd(GpuPass pass)
+{
+    if(!s_initialized) return;
+    glEndQuery(GL_SAMPLES_PASSED);
+    glEndQuery(GL_TIME_ELAPSED);
+    s_passes[pass].issued[s_frameSet] = true;
+}
+
+void gpuTimersEndFrame()
+{
+    if(!s_initialized) return;
+    s_frameSet = (s_frameSet + 1) % QUERY_SETS;
+
+    // The set we are about to reuse was issued a frame ago. Read it only if
+    // the GPU has finished; otherwise drop that sample rather than stall.
+    for(int p = 0; p < GPU_PASS_COUNT; p++) {
+        PassTimer &t = s_passes[p];
+        if(!t.issued[s_frameSet]) continue;
+        t.issued[s_frameSet] = false;
+        GLint available = 0, samplesAvailable = 0;
+        glGetQueryObjectiv(t.queries[s_frameSet], GL_QUERY_RESULT_AVAILABLE, &available);
+        glGetQueryObjectiv(t.sampleQueries[s_frameSet], GL_QUERY_RESULT_AVAILABLE, &samplesAvailable);
+        if(!available || !samplesAvailable) continue;
+        GLuint64 samples = 0;
+        glGetQueryObjectui64v(t.sampleQueries[s_frameSet], GL_QUERY_RESULT, &samples);
+        t.samples = samples;
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(t.queries[s_frameSet], GL_QUERY_RESULT, &elapsedNs);
+        float ms = (float)(elapsedNs / 1.0e6);
+        t.smoothedMs = (t.smoothedMs == 0.0f) ? ms : t.smoothedMs * 0.9f + ms * 0.1f;
+        if(profilerEnabled()) {
+            uint64_t start = t.cpuStartNs[s_frameSet];
+            profilerRecordGpu(s_passNames[p], start, start + elapsedNs);
+        }
+    }
+}
+
+float gpuTimerMs(GpuPass pass)
+{
+    return s_passes[pass].smoothedMs;
+}
+
+unsigned long long gpuPassSamples(GpuPass pass)
+{
+    return s_passes[pass].samples;
+}
+
+const char* gpuPassName(GpuPass pass)
+{
+    return s_passNames[pass];
+}
+
+void gpuTimersDrawBars(float x, float y)
+{
+    static const float colors[GPU_PASS_COUNT][3] = {
+        { 0.2f, 0.8f, 0.2f },  // world
+        { 0.9f, 0.7f, 0.1f },  // held item
+        { 0.3f, 0.5f, 1.0f }   // UI
+    };
+    const float chartW = 200.0f, barH = 8.0f, gap = 4.0f, pad = 4.0f;
+    const float msPerChart = 16.6f;
+    float chartH = GPU_PASS_COUNT * barH + (GPU_PASS_COUNT - 1) * gap;
+    uiRect(x - pad, y - pad, chartW + 2 * pad, chartH + 2 * pad, 0.0f, 0.0f, 0.0f, 0.5f);
+    for(int p = 0; p < GPU_PASS_COUNT; p++) {
+        float w = s_passes[p].smoothedMs / msPerChart * chartW;
+        if(w > chartW) w = chartW;
+        float by = y + chartH - barH - p * (barH + gap);
+        uiRect(x, by, w, barH, colors[p][0], colors[p][1], colors[p][2], 0.9f);
+    }
+    // Frame budget marker at 16.6 ms.
+    uiRect(x + chartW, y - pad, 1.0f, chartH + 2 * pad, 1.0f, 1.0f, 1.0f, 0.8f);
+}
@@ -0,0 +1,45 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+// Per-pass GPU timing using GL_TIME_ELAPSED queries, and fragment counts
+// using GL_SAMPLES_PASSED: fragments that passed the depth test, which
+// with early depth testing is about how many were shaded.
+//
+// Each pass owns two sets of queries; a frame issues into one set while the
+// other (from the previous frame) is read back, and only if its result is
+// already available, so the CPU never waits on the GPU. Results are
+// smoothed for display and, while the profiler is capturing, also added to
+// the trace on a "GPU" track.
+
+enum GpuPass {
+    GPU_PASS_WORLD,
+    GPU_PASS_HELD_ITEM,
+    GPU_PASS_UI,
+    GPU_PASS_COUNT
+};
+
+void gpuTimersInit();
+void gpuTimersShutdown();
+
+// Brackets a pass. Passes must not nest (GL allows one TIME_ELAPSED query
+// at a time).
+void gpuTimerBegin(GpuPass pass);
+void gpuTimerEnd(GpuPass pass);
+
+// Call once per frame after the last pass: collects finished results and
+// flips to the other query set.
+void gpuTimersEndFrame();
+
+// Smoothed GPU time of a pass in milliseconds (0 until the first result).
+float gpuTimerMs(GpuPass pass);
+
+// Samples that passed the depth test in the last pass read back.
+unsigned long long gpuPassSamples(GpuPass pass);
+const char* gpuPassName(GpuPass pass);
+
+// Draws a small bar chart of the pass timings through the UI batcher
+// (between uiBegin and uiFlush). Bars are scaled so 16.6 ms spans the
+// chart width.
+void gpuTimersDrawBars(float x, float y);
+
+#endif // GPUTIMER_H
@@ -0,0 +1,164 @@
+#include "headless.h"
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static EGLDisplay s_display = EGL_NO_DISPLAY;
+static EGLContext s_context = EGL_NO_CONTEXT;
+static GLuint s_fbo = 0, s_colorRB = 0, s_depthRB = 0;
+static int s_width = 0, s_height = 0;
+
+static EGLDisplay openDisplay() {
+    // Prefer the surfaceless platform: it needs neither X11/Wayland nor a
+    // DRM device, so it works in containers.
+    const char* exts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if(exts && std::strstr(exts, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if(getPlatformDisplay) {
+            EGLDisplay dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if(dpy != EGL_NO_DISPLAY)
+                return dpy;
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool headlessInit()
+{
+    s_display = openDisplay();
+    EGLint major = 0, minor = 0;
+    if(s_display == EGL_NO_DISPLAY || !eglInitialize(s_display, &major, &minor)) {
+        std::cerr << "[Headless] No EGL display\n";
+        s_display = EGL_NO_DISPLAY;
+        return false;
+    }
+    const char* exts = eglQueryString(s_display, EGL_EXTENSIONS);
+    if(!exts || !std::strstr(exts, "EGL_KHR_surfaceless_context")) {
+        std::cerr << "[Headless] EGL_KHR_surfaceless_context not supported\n";
+        headlessShutdown();
+        return false;
+    }
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "[Headless] Desktop OpenGL not available through EGL\n";
+        headlessShutdown();
+        return false;
+    }
+
+    // No surface is ever created, so don't let the default
+    // (EGL_WINDOW_BIT) rule out configs.
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if(!eglChooseConfig(s_display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        std::cerr << "[Headless] No suitable EGL config\n";
+        headlessShutdown();
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    s_context = eglCreateContext(s_display, config, EGL_NO_CONTEXT, contextAttribs);
+    if(s_context == EGL_NO_CONTEXT ||
+       !eglMakeCurrent(s_display, EGL_NO_SURFACE, EGL_NO_SURFACE, s_context)) {
+        std::cerr << "[Headless] Can't create a GL 3.3 core context (EGL error 0x"
+                  << std::hex << eglGetError() << std::dec << ")\n";
+        headlessShutdown();
+        return false;
+    }
+    std::cout << "[Headless] EGL " << major << "." << minor << ", "
+              << eglQueryString(s_display, EGL_VENDOR) << "\n";
+    return true;
+}
+
+bool headlessActive()
+{
+    return s_context != EGL_NO_CONTEXT;
+}
+
+bool headlessCreateTarget(int width, int height)
+{
+    s_width = width;
+    s_height = height;
+    glGenRenderbuffers(1, &s_colorRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, s_colorRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &s_depthRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, s_depthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &s_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, s_fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, s_colorRB);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, s_depthRB);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "[Headless] Offscreen framebuffer incomplete\n";
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    std::cout << "[Headless] Rendering offscreen at " << width << "x" << height
+              << " (" << glGetString(GL_RENDERER) << ")\n";
+    return true;
+}
+
+void headlessPresent()
+{
+    glFinish();
+}
+
+bool headlessWritePPM(const char* filename)
+{
+    if(!s_fbo) return false;
+    std::vector<unsigned char> pixels((size_t)s_width * s_height * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, s_fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, s_width, s_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    FILE* f = fopen(filename, "wb");
+    if(!f) {
+        std::cerr << "[Headless] Can't write " << filename << "\n";
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", s_width, s_height);
+    // GL rows start at the bottom.
+    for(int y = s_height - 1; y >= 0; y--)
+        fwrite(&pixels[(size_t)y * s_width * 3], 1, (size_t)s_width * 3, f);
+    fclose(f);
+    std::cout << "[Headless] Wrote " << filename << "\n";
+    return true;
+}
+
+void headlessShutdown()
+{
+    if(s_fbo) {
+        glDeleteFramebuffers(1, &s_fbo);
+        glDeleteRenderbuffers(1, &s_colorRB);
+        glDeleteRenderbuffers(1, &s_depthRB);
+        s_fbo = s_colorRB = s_depthRB = 0;
+    }
+    if(s_display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(s_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if(s_context != EGL_NO_CONTEXT)
+            eglDestroyContext(s_display, s_context);
+        eglTerminate(s_display);
+    }
+    s_context = EGL_NO_CONTEXT;
+    s_display = EGL_NO_DISPLAY;
+}
@@ -0,0 +1,30 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// Offscreen rendering without a display, for render benchmarks and image
+// comparisons on headless machines (e.g. Mesa's llvmpipe/softpipe in CI).
+//
+// headlessInit() creates a GL 3.3 core context through EGL on Mesa's
+// surfaceless platform (falling back to the default EGL display) and makes
+// it current with no window surface. After GLEW is initialised,
+// headlessCreateTarget() creates a framebuffer object with colour and depth
+// attachments and binds it, so the normal render path draws into it
+// unchanged.
+
+bool headlessInit();
+bool headlessActive();
+
+// Creates and binds the offscreen width x height render target. Needs a
+// current context with GL entry points loaded.
+bool headlessCreateTarget(int width, int height);
+
+// Stands in for SDL_GL_SwapWindow: waits for the frame to finish so frame
+// times include the GPU (or software rasteriser) work.
+void headlessPresent();
+
+// Writes the render target as a binary PPM (P6), top row first.
+bool headlessWritePPM(const char* filename);
+
+void headlessShutdown();
+
+#endif // HEADLESS_H
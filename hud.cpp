@@ -0,0 +1,44 @@
+#include "hud.h"
+#include "font.h"
+#include "gputimer.h"
+#include "stats.h"
+#include "ui.h"
+#include <cstdio>
+
+void hudDraw(int /*screenW*/, int screenH, const HudWorldInfo &world)
+{
+    const float scale = 2.0f;
+    const float lineH = fontLineHeight(scale);
+    const float x = 10.0f;
+    const int   lineCount = 8;
+    PerfSummary sum = statsSummary();
+
+    char lines[lineCount][128];
+    snprintf(lines[0], sizeof(lines[0]), "FPS %.0f  frame p50 %.1fms  p99 %.1fms  view %d",
+             sum.fps, sum.frameMsP50, sum.frameMsP99, g_perf.renderDistance);
+    snprintf(lines[1], sizeof(lines[1]), "chunks loaded %zu  visible %d + %d lod  queued %d  culled %d",
+             world.loadedChunks, g_perf.visibleChunks, g_perf.visibleLodChunks, g_perf.loadPending,
+             g_perf.culledSections);
+    snprintf(lines[2], sizeof(lines[2]), "draw calls %d  vertices %lld",
+             g_perf.drawCalls, g_perf.verticesSubmitted);
+    snprintf(lines[3], sizeof(lines[3]), "generated/s %.1f  rebuilt/s %.1f  remesh queue %d  arena grows %d",
+             sum.chunksGeneratedPerSec, sum.chunksRebuiltPerSec, g_perf.remeshPending,
+             g_perf.meshArenaGrowths);
+    snprintf(lines[4], sizeof(lines[4]), "water active %d  waterLevels %zu",
+             g_perf.activeWaterCells, world.waterLevels);
+    snprintf(lines[5], sizeof(lines[5]), "extraBlocks %zu  columns %.0f KiB  packed %zu",
+             world.extraBlocks, world.columnBytes / 1024.0, world.packedChunks);
+    snprintf(lines[6], sizeof(lines[6]), "uploads %.2f MB/frame  queued %d",
+             g_perf.uploadBytes / (1024.0 * 1024.0), g_perf.uploadPending);
+    snprintf(lines[7], sizeof(lines[7]), "gpu world %.2fms  held %.2fms  ui %.2fms",
+             gpuTimerMs(GPU_PASS_WORLD), gpuTimerMs(GPU_PASS_HELD_ITEM), gpuTimerMs(GPU_PASS_UI));
+
+    // Below the fly indicator in the top-left corner.
+    float top = (float)screenH - 35.0f;
+    float bottom = top - lineCount * lineH;
+    uiRect(x - 5.0f, bottom - 5.0f, 520.0f, top - bottom + 10.0f, 0.0f, 0.0f, 0.0f, 0.5f);
+    for(int i = 0; i < lineCount; i++)
+        fontDrawText(x, top - (i + 1) * lineH, lines[i], scale);
+
+    gpuTimersDrawBars(x, bottom - 50.0f);
+}
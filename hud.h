@@ -0,0 +1,21 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <cstddef>
+
+// Toggleable performance overlay (F3). Text is drawn with the bitmap font
+// through the UI batcher, so hudDraw() must be called between uiBegin()
+// and uiFlush().
+
+// World sizes the HUD can't see on its own.
+struct HudWorldInfo {
+    size_t loadedChunks;
+    size_t packedChunks;   // loaded chunks whose columns are packed
+    size_t columnBytes;    // memory held by all chunks' columns
+    size_t extraBlocks;
+    size_t waterLevels;
+};
+
+void hudDraw(int screenW, int screenH, const HudWorldInfo &world);
+
+#endif // HUD_H
@@ -8,13 +8,14 @@
 #include "math.h"    // for Mat4, Vec3, perspectiveMatrix, lookAtMatrix, identityMatrix, etc.
 #include "texture.h" // for texture functions
 #include "world.h"   // for BLOCK_GRASS, BLOCK_STONE, etc.
+#include "ui.h"      // for the batched 2D renderer
+#include "stats.h"   // for draw call counters
 
 // External symbols defined elsewhere.
 extern GLuint worldShader;
 extern GLuint texID;
 extern int SCREEN_WIDTH;
 extern int SCREEN_HEIGHT;
-extern GLuint uiShader;
 
 //
 // Helper: Rotate matrix around Y-axis
@@ -31,53 +32,9 @@ static Mat4 rotateYMatrix(const Mat4 &m, float angle)
     return multiplyMatrix(m, rot);
 }
 
-//
-// Simple 2D rectangle drawing function
-//
-static void drawRect2D(float x, float y, float w, float h,
-                       float r, float g, float b, float a,
-                       int screenW, int screenH)
-{
-    float vertices[12] = {
-        x,   y,
-        x+w, y,
-        x+w, y+h,
-        x,   y,
-        x+w, y+h,
-        x,   y+h
-    };
-
-    static GLuint s_vao = 0, s_vbo = 0;
-    static bool s_init = false;
-    if(!s_init){
-        glGenVertexArrays(1, &s_vao);
-        glGenBuffers(1, &s_vbo);
-        s_init = true;
-    }
-
-    glBindVertexArray(s_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    float left = 0.0f, right = (float)screenW;
-    float bottom = 0.0f, top = (float)screenH;
-    Mat4 ortho = {};
-    ortho.m[0]  =  2.0f/(right-left);
-    ortho.m[5]  =  2.0f/(top-bottom);
-    ortho.m[10] = -1.0f;
-    ortho.m[15] =  1.0f;
-    ortho.m[12] = -(right+left)/(right-left);
-    ortho.m[13] = -(top+bottom)/(top-bottom);
-
-    glUseProgram(uiShader);
-    GLint pLoc = glGetUniformLocation(uiShader, "uProj");
-    glUniformMatrix4fv(pLoc, 1, GL_FALSE, ortho.m);
-    GLint cLoc = glGetUniformLocation(uiShader, "uColor");
-    glUniform4f(cLoc, r, g, b, a);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-}
+// Icon atlas layout: each block icon occupies one ICON_SIZE cell.
+static const int ICON_SIZE     = 64;
+static const int ATLAS_COLUMNS = 8;
 
 //
 // Helper to draw a block preview.
@@ -133,6 +90,8 @@ static void drawBlockPreview(int blockID, float x, float y, float size, bool hov
     glEnableVertexAttribArray(1);
 
     glDrawArrays(GL_TRIANGLES, 0, 36);
+    g_perf.drawCalls++;
+    g_perf.verticesSubmitted += 36;
     glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
 }
 
@@ -142,6 +101,10 @@ static void drawBlockPreview(int blockID, float x, float y, float size, bool hov
 Inventory::Inventory()
     : m_isOpen(false)
     , m_selectedBlock(BLOCK_NONE)
+    , m_iconAtlas(0)
+    , m_atlasWidth(0)
+    , m_atlasHeight(0)
+    , m_atlasBuilt(false)
 {
     // Original blocks
     m_items.push_back(BLOCK_GRASS);
@@ -176,6 +139,68 @@ Inventory::Inventory()
     m_items.push_back(BLOCK_WOOL_ORANGE);
 }
 
+//
+// Render every (static) block icon once into an offscreen texture.
+// Called lazily on the first frame the inventory is shown, since it needs
+// the world shader and block texture to be ready. If the framebuffer can't
+// be created, m_iconAtlas stays 0 and render() falls back to live previews.
+//
+void Inventory::buildIconAtlas()
+{
+    m_atlasBuilt = true;
+    int atlasRows = ((int)m_items.size() + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    m_atlasWidth  = ATLAS_COLUMNS * ICON_SIZE;
+    m_atlasHeight = atlasRows * ICON_SIZE;
+
+    glGenTextures(1, &m_iconAtlas);
+    glBindTexture(GL_TEXTURE_2D, m_iconAtlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_atlasWidth, m_atlasHeight, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLuint depthRB, fbo;
+    glGenRenderbuffers(1, &depthRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_atlasWidth, m_atlasHeight);
+
+    GLint oldFBO;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_iconAtlas, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRB);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+        GLint oldViewport[4];
+        glGetIntegerv(GL_VIEWPORT, oldViewport);
+        glViewport(0, 0, m_atlasWidth, m_atlasHeight);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glEnable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+        for(size_t i = 0; i < m_items.size(); i++) {
+            int col = i % ATLAS_COLUMNS;
+            int row = i / ATLAS_COLUMNS;
+            drawBlockPreview(m_items[i], (float)(col * ICON_SIZE), (float)(row * ICON_SIZE),
+                             (float)ICON_SIZE, false);
+        }
+        glDisable(GL_DEPTH_TEST);
+        glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
+    } else {
+        std::cerr << "[Inventory] Icon atlas framebuffer incomplete, using live previews\n";
+        glDeleteTextures(1, &m_iconAtlas);
+        m_iconAtlas = 0;
+    }
+
+    // The atlas texture is all we keep; the framebuffer is only needed once.
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)oldFBO);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &depthRB);
+}
+
 void Inventory::toggle()
 {
     m_isOpen = !m_isOpen;
@@ -245,22 +270,24 @@ void Inventory::render()
     float regionY = (SCREEN_HEIGHT - regionHeight) * 0.5f;
     
     // Draw the background UI box
-    glUseProgram(uiShader);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    drawRect2D(regionX, regionY, regionWidth, regionHeight,
-               0.0f, 0.0f, 0.0f, 0.7f,
-               SCREEN_WIDTH, SCREEN_HEIGHT);
-    glDisable(GL_BLEND);
+    uiRect(regionX, regionY, regionWidth, regionHeight,
+           0.0f, 0.0f, 0.0f, 0.7f);
     
     // Top-left of the grid (items are drawn from top down)
     float startX = regionX + margin;
     float startY = regionY + regionHeight - margin - itemSize;
     
     int mouseX, mouseY;
-    Uint32 mState = SDL_GetMouseState(&mouseX, &mouseY);
+    SDL_GetMouseState(&mouseX, &mouseY);
     int invMouseY = SCREEN_HEIGHT - mouseY;
-    
+
+    if(!m_atlasBuilt)
+        buildIconAtlas();
+
+    // Static icons are queued as textured quads on the UI batch, which then
+    // draws the background and the whole grid together. Hovered items are
+    // skipped here and rendered live afterwards so they can rotate.
+    int hoveredIndex = -1;
     for(size_t i = 0; i < count; i++){
         int row = i / columns;
         int col = i % columns;
@@ -268,9 +295,32 @@ void Inventory::render()
         float y = startY - row * (itemSize + spacing);
         bool hovered = (mouseX >= x && mouseX <= (x + itemSize) &&
                         invMouseY >= y && invMouseY <= (y + itemSize));
-        drawBlockPreview(m_items[i], x, y, itemSize, hovered);
+        if(hovered) {
+            hoveredIndex = (int)i;
+            continue;
+        }
+        if(!m_iconAtlas)
+            continue;
+        float u0 = (float)((i % ATLAS_COLUMNS) * ICON_SIZE) / m_atlasWidth;
+        float v0 = (float)((i / ATLAS_COLUMNS) * ICON_SIZE) / m_atlasHeight;
+        float u1 = u0 + (float)ICON_SIZE / m_atlasWidth;
+        float v1 = v0 + (float)ICON_SIZE / m_atlasHeight;
+        uiTexturedRect(x, y, itemSize, itemSize, m_iconAtlas, u0, v0, u1, v1);
     }
-    
+    uiFlush();
+    glDisable(GL_DEPTH_TEST);
+
+    // Without an atlas every icon falls back to a live preview.
+    for(size_t i = 0; i < count; i++){
+        if((int)i != hoveredIndex && m_iconAtlas)
+            continue;
+        int row = i / columns;
+        int col = i % columns;
+        float x = startX + col * (itemSize + spacing);
+        float y = startY - row * (itemSize + spacing);
+        drawBlockPreview(m_items[i], x, y, itemSize, (int)i == hoveredIndex);
+    }
+
     glEnable(GL_DEPTH_TEST);
 }
 
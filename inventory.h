@@ -2,6 +2,7 @@
 #define INVENTORY_H
 
 #include <vector>
+#include <GL/glew.h>
 #include "camera.h"
 #include "world.h" // For BlockType constants like BLOCK_GRASS, BLOCK_STONE, etc.
 
@@ -29,6 +30,15 @@ private:
 
     // Simple list of block IDs to display in the inventory
     std::vector<int> m_items;
+
+    // Static block icons are rendered once into this atlas (see buildIconAtlas)
+    // and drawn as a single batch of textured quads each frame.
+    GLuint m_iconAtlas;
+    int    m_atlasWidth;
+    int    m_atlasHeight;
+    bool   m_atlasBuilt;
+
+    void buildIconAtlas();
 };
 
 #endif
@@ -0,0 +1,71 @@
+#include "loadqueue.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Generated terrain and trees stay below this height, so a chunk's
+// bounding box for the frustum test is y = 0 .. CHUNK_BOX_TOP.
+static const float CHUNK_BOX_TOP = 64.0f;
+
+namespace {
+
+struct LoadRequest {
+    int cx, cz;
+    bool inView;
+    float distSq;
+};
+
+}
+
+// Sorted least urgent first, so the next request is at the back. Rebuilt
+// on every update: the square around the player is small enough that
+// re-sorting it is cheaper than keeping a heap in sync with a moving
+// camera, and requests that fell out of range or behind the player are
+// dropped or demoted for free.
+static std::vector<LoadRequest> s_queue;
+
+static bool moreUrgent(const LoadRequest &a, const LoadRequest &b) {
+    if(a.inView != b.inView) return a.inView;
+    return a.distSq < b.distSq;
+}
+
+void loadQueueUpdate(float x, float z, const Frustum &view, int radius,
+                     bool (*isLoaded)(int cx, int cz))
+{
+    PROFILE_ZONE("loadQueueUpdate");
+    int pcx = (int)std::floor(x / 16.0f);
+    int pcz = (int)std::floor(z / 16.0f);
+    s_queue.clear();
+    for(int cx = pcx - radius; cx <= pcx + radius; cx++) {
+        for(int cz = pcz - radius; cz <= pcz + radius; cz++) {
+            if(isLoaded(cx, cz)) continue;
+            LoadRequest r;
+            r.cx = cx;
+            r.cz = cz;
+            Vec3 boxMin = { cx * 16.0f, 0.0f, cz * 16.0f };
+            Vec3 boxMax = { cx * 16.0f + 16.0f, CHUNK_BOX_TOP, cz * 16.0f + 16.0f };
+            r.inView = (std::abs(cx - pcx) <= 1 && std::abs(cz - pcz) <= 1) ||
+                       frustumIntersectsBox(view, boxMin, boxMax);
+            float dx = cx * 16.0f + 8.0f - x, dz = cz * 16.0f + 8.0f - z;
+            r.distSq = dx * dx + dz * dz;
+            s_queue.push_back(r);
+        }
+    }
+    std::sort(s_queue.begin(), s_queue.end(),
+              [](const LoadRequest &a, const LoadRequest &b) { return moreUrgent(b, a); });
+}
+
+bool loadQueuePop(int &cx, int &cz)
+{
+    if(s_queue.empty()) return false;
+    cx = s_queue.back().cx;
+    cz = s_queue.back().cz;
+    s_queue.pop_back();
+    return true;
+}
+
+size_t loadQueueSize()
+{
+    return s_queue.size();
+}
@@ -0,0 +1,25 @@
+#ifndef LOADQUEUE_H
+#define LOADQUEUE_H
+
+#include <cstddef>
+#include "math.h"
+
+// Chunks waiting to be generated, most urgent first, so the ground in
+// front of the player appears before the rest. Call loadQueueUpdate()
+// every frame: it requests the missing chunks within the radius, drops
+// requests that are no longer in range, and re-sorts the rest for the
+// current position and view:
+//  - chunks in the view frustum before those outside it (the eight
+//    around the player always count as in view: the player collides
+//    with them),
+//  - then nearest first.
+
+void loadQueueUpdate(float x, float z, const Frustum &view, int radius,
+                     bool (*isLoaded)(int cx, int cz));
+
+// Takes the most urgent request. False when nothing is queued.
+bool loadQueuePop(int &cx, int &cz);
+
+size_t loadQueueSize();
+
+#endif // LOADQUEUE_H
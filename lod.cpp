@@ -0,0 +1,53 @@
+#include "lod.h"
+#include "cube.h"
+#include "profiler.h"
+#include "terrain.h"
+#include <algorithm>
+
+static const int CHUNK = 16;
+// Cells per side at the finest step, plus the border ring.
+static const int MAX_CELLS = CHUNK / 2 + 2;
+
+void buildLodMesh(int cx, int cz, int step, MeshArena &out)
+{
+    PROFILE_ZONE("buildLodMesh");
+    int n = CHUNK / step;
+    // Cell (i, j) = [z][x] covers columns from the chunk origin plus
+    // (j - 1, i - 1) * step; row/column 0 and n + 1 belong to neighbours.
+    int top[MAX_CELLS][MAX_CELLS];
+    BlockType surface[MAX_CELLS][MAX_CELLS];
+    int originX = cx * CHUNK, originZ = cz * CHUNK;
+    for(int i = 0; i <= n + 1; i++) {
+        for(int j = 0; j <= n + 1; j++) {
+            bool corner = (i == 0 || i == n + 1) && (j == 0 || j == n + 1);
+            if(corner) continue;
+            TerrainColumn col = sampleTerrainColumn(originX + (j - 1) * step + step / 2,
+                                                    originZ + (i - 1) * step + step / 2);
+            top[i][j] = naturalTopY(col.biome, col.height);
+            surface[i][j] = naturalBlockAt(col.biome, col.height, top[i][j]);
+        }
+    }
+
+    // Neighbour offsets (di, dj) of the four walls.
+    static const int walls[4][2] = { {1, 0}, {-1, 0}, {0, -1}, {0, 1} };
+    static const CubeFace wallFaces[4] = { FACE_POS_Z, FACE_NEG_Z, FACE_NEG_X, FACE_POS_X };
+    for(int i = 1; i <= n; i++) {
+        for(int j = 1; j <= n; j++) {
+            float x0 = (float)(originX + (j - 1) * step), x1 = x0 + step;
+            float z0 = (float)(originZ + (i - 1) * step), z1 = z0 + step;
+            int h = top[i][j];
+            BlockType t = surface[i][j];
+            float y1 = (float)(h + 1);
+            writeBoxFace(out.append(FACE_FLOATS), x0, 0.0f, z0, x1, y1, z1, t, FACE_POS_Y);
+            for(int w = 0; w < 4; w++) {
+                int ni = i + walls[w][0], nj = j + walls[w][1];
+                int nh = top[ni][nj];
+                bool border = ni == 0 || ni == n + 1 || nj == 0 || nj == n + 1;
+                int bottom = border ? std::max(0, std::min(h, nh) + 1 - LOD_SKIRT) : nh + 1;
+                if(bottom >= h + 1) continue;
+                writeBoxFace(out.append(FACE_FLOATS), x0, (float)bottom, z0, x1, y1, z1,
+                             t, wallFaces[w]);
+            }
+        }
+    }
+}
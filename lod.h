@@ -0,0 +1,24 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include "mesharena.h"
+
+// Level-of-detail meshes for chunks beyond the full-resolution render
+// distance, built from the terrain heightmap and biomes alone (no trees,
+// no edits). A chunk at step 2, 4 or 8 is drawn as cells of step x step
+// columns, each a box up to the height of the column at the cell's centre
+// topped with that column's surface block.
+//
+// Cells sample the terrain on a grid aligned to multiples of the step, so
+// neighbouring chunks at the same step meet without gaps. Where the step
+// changes (or a full-resolution chunk starts) heights along the border
+// disagree, so every border cell also hangs a skirt LOD_SKIRT blocks
+// below the lower of its own and its neighbour's height to hide the crack.
+
+static const int LOD_SKIRT = 8;
+
+// Appends the LOD mesh of chunk (cx, cz) at the given step (2, 4, 8 or
+// 16) to out, in the same vertex layout as the chunk meshes.
+void buildLodMesh(int cx, int cz, int step, MeshArena &out);
+
+#endif // LOD_H
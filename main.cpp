@@ -7,6 +7,9 @@
 #include <tuple>
 #include <cstdlib>
 #include <ctime>
+#include <string>
+#include <algorithm>
+#include <memory>
 
 #include "math.h"       // Provides identityMatrix(), multiplyMatrix(), vector math, etc.
 #include "shader.h"     // Shader compilation and program creation
@@ -15,7 +18,24 @@
 #include "texture.h"    // loadTexture()
 #include "noise.h"
 #include "world.h"
+#include "terrain.h"
+#include "mesher.h"
+#include "columnpack.h"
+#include "lod.h"
+#include "occlusion.h"
+#include "viewdistance.h"
 #include "inventory.h"
+#include "ui.h"
+#include "profiler.h"
+#include "gputimer.h"
+#include "font.h"
+#include "hud.h"
+#include "loadqueue.h"
+#include "stats.h"
+#include "remesh.h"
+#include "replay.h"
+#include "headless.h"
+#include "upload.h"
 #include "globals.h"
 
 // Global texture variable for the hand.
@@ -61,9 +81,7 @@ static bool raycastBlock(const Vec3 &start, const Vec3 &dir, float maxDist, int
         int bx = (int)std::floor(pos.x);
         int by = (int)std::floor(pos.y);
         int bz = (int)std::floor(pos.z);
-        std::tuple<int,int,int> key = {bx, by, bz};
-        if(isSolidBlock(bx, by, bz) ||
-           (extraBlocks.find(key) != extraBlocks.end() && extraBlocks[key] == BLOCK_LEAVES)) {
+        if(isTargetBlock(bx, by, bz)) {
             outX = bx; outY = by; outZ = bz;
             return true;
         }
@@ -110,6 +128,8 @@ void renderHeldBlock3D(const Mat4 &proj, int activeBlock) {
     glEnableVertexAttribArray(1);
     
     glDrawArrays(GL_TRIANGLES, 0, 36);
+    g_perf.drawCalls++;
+    g_perf.verticesSubmitted += 36;
     
     glBindVertexArray(0);
     glDeleteBuffers(1, &heldVBO);
@@ -167,6 +187,8 @@ void renderHandRect(const Mat4 &proj) {
     glEnableVertexAttribArray(1);
     
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    g_perf.drawCalls++;
+    g_perf.verticesSubmitted += 6;
     
     glBindVertexArray(0);
     glDeleteBuffers(1, &handVBO);
@@ -179,7 +201,38 @@ int SCREEN_WIDTH  = 1280;
 int SCREEN_HEIGHT = 720;
 
 static const int chunkSize      = 16;
-static const int renderDistance = 6;
+// Chunks drawn at full resolution around the player's chunk (on either
+// axis). Adjusted at runtime to hold --frame-target (see viewdistance.h)
+// unless fixed with --render-distance, and always fixed for headless runs
+// and replays so they stay reproducible.
+static int renderDistance = 6;
+static const int MIN_RENDER_DISTANCE = 3;
+static const int MAX_RENDER_DISTANCE = 12;
+// Milliseconds per frame spent rebuilding sections from the remesh queue.
+static const float REMESH_BUDGET_MS = 2.0f;
+// Chunks generated per frame from the load queue. A count rather than a
+// time budget so that replays load the world in the same order.
+static const int LOAD_CHUNKS_PER_FRAME = 4;
+// Chunks more than this many chunks beyond renderDistance keep their
+// columns run-length encoded until they are next remeshed.
+static const int COLD_CHUNK_MARGIN = 2;
+
+// Level-of-detail rings beyond renderDistance (see lod.h): chunks up to
+// `rings` chunks further out are drawn with cells of `step` columns.
+struct LodLevel {
+    int step;
+    int rings;
+};
+static const LodLevel LOD_LEVELS[] = {
+    { 2, 6 },
+    { 4, 14 },
+    { 8, 22 },
+};
+static const int LOD_RINGS = 22;
+// LOD meshes built per frame, nearest ring first.
+static const int LOD_CHUNKS_PER_FRAME = 16;
+// Height of the boxes LOD chunks are frustum-tested with.
+static const float LOD_BOX_TOP = 64.0f;
 
 static const float playerWidth  = 0.6f;
 static const float playerHeight = 1.8f;
@@ -188,89 +241,76 @@ static const float WORLD_FLOOR_LIMIT = -10.0f;
 static const float GRAVITY    = -9.81f;
 static const float JUMP_SPEED =  5.0f;
 
-// 3D pipeline globals.
-GLuint worldShader = 0;
-GLuint texID       = 0;
+// 3D pipeline globals. worldOpaqueShader is worldShader without the alpha
+// test, for the opaque layer.
+GLuint worldShader       = 0;
+GLuint worldOpaqueShader = 0;
+GLuint texID             = 0;
 
-// 2D UI pipeline globals.
-GLuint uiShader    = 0;
-GLuint uiVAO       = 0;
-GLuint uiVBO       = 0;
+// A chunk is a 16x16 column split into 16-block-tall sections, each with
+// its own mesh so an edit only remeshes the section it touches. Meshes
+// live only on the GPU; the CPU side keeps what drawing needs.
+struct ChunkSection {
+    SectionFill fill;
+    GLsizei layerVertices[RENDER_LAYER_COUNT]; // stored back to back in the VBO
+    GLuint VAO, VBO;   // 0 until the section first has geometry
+};
 
-// A chunk holds geometry for a 16x16 area.
 struct Chunk {
     int chunkX, chunkZ;
-    std::vector<float> vertices;
-    GLuint VAO, VBO;
+    std::unique_ptr<ChunkColumns> columns; // null while the chunk is cold,
+    PackedColumns packed;                  // when this holds them instead
+    std::vector<ChunkSection> sections;    // index = section y
+    std::vector<OcclusionBox> occluders;   // rebuilt when needed after a remesh
+    bool occludersStale;
 };
 
-std::unordered_map<std::pair<int,int>, Chunk, PairHash> chunks;
+// Keyed by packChunkKey(cx, cz).
+FlatMap<Chunk> chunks;
 
-// Biome definitions.
-enum Biome {
-    BIOME_PLAINS,
-    BIOME_DESERT,
-    BIOME_EXTREME_HILLS,
-    BIOME_FOREST,
-    BIOME_OCEAN
+// A heightmap mesh drawn for a chunk beyond renderDistance, or for one
+// inside it that hasn't been generated yet.
+struct LodChunk {
+    int chunkX, chunkZ;
+    int step;
+    GLsizei vertexCount;
+    GLuint VAO, VBO;
 };
 
-static Biome getBiome(int x, int z) {
-    float oceanNoise = perlinNoise(x * 0.001f, z * 0.001f);
-    if(oceanNoise < -0.8f)
-        return BIOME_OCEAN;
-    float freq1 = 0.0035f, freq2 = 0.0037f;
-    float n1 = perlinNoise(x * freq1, z * freq1);
-    float n2 = perlinNoise((x+1000)*freq2, (z+1000)*freq2);
-    float combined = 0.5f * (n1 + n2);
-    if(combined < -0.4f)
-        return BIOME_DESERT;
-    else if(combined < -0.1f)
-        return BIOME_PLAINS;
-    else if(combined < 0.2f)
-        return BIOME_FOREST;
-    else
-        return BIOME_EXTREME_HILLS;
-}
+// Keyed by packChunkKey(cx, cz).
+FlatMap<LodChunk> lodChunks;
 
-int getTerrainHeightAt(int x, int z) {
-    Biome b = getBiome(x, z);
-    if(b == BIOME_OCEAN)
-        return 8;
-    if(b == BIOME_EXTREME_HILLS) {
-        float freq = 0.0007f;
-        int octaves = 8;
-        float lacunarity = 2.3f, gain = 0.5f;
-        float n = fbmNoise(x * freq, z * freq, octaves, lacunarity, gain);
-        float normalized = 0.5f * (n + 1.0f);
-        if(normalized < 0.0f) normalized = 0.0f;
-        if(normalized > 1.0f) normalized = 1.0f;
-        return (int)(powf(normalized, 2.0f) * 40.0f);
-    } else {
-        float n = fbmNoise(x * 0.01f, z * 0.01f, 6, 2.0f, 0.5f);
-        float normalized = 0.5f * (n + 1.0f);
-        return (int)(normalized * 24.0f);
-    }
+// Set whenever a chunk or section (sectionOrderStale) or LOD mesh
+// (lodOrderStale) is added or removed, which also moves the ones in the
+// same container, or renderDistance changes; the draw order of that kind
+// is then rebuilt before it is next used. They are separate so LOD
+// streaming doesn't throw away the occlusion result for the sections.
+static bool sectionOrderStale = true, lodOrderStale = true;
+
+static bool isChunkLoaded(int cx, int cz) {
+    return chunks.find(packChunkKey(cx, cz)) != chunks.end();
 }
 
-static bool blockHasCollision(BlockType t) {
-    return (t != BLOCK_WATER);
+// The far plane reaches the outer LOD ring's corners, with some slack.
+static Mat4 worldProjection() {
+    float farPlane = (renderDistance + LOD_RINGS + 1) * chunkSize * 1.5f;
+    return perspectiveMatrix(45.0f*(3.14159f/180.0f),
+                             (float)SCREEN_WIDTH/(float)SCREEN_HEIGHT,
+                             0.1f, farPlane);
 }
 
-bool isSolidBlock(int bx, int by, int bz) {
-    auto key = std::make_tuple(bx, by, bz);
-    if(extraBlocks.find(key) != extraBlocks.end()){
-        BlockType t = extraBlocks[key];
-        if((int)t < 0) return false;
-        return blockHasCollision(t);
-    }
-    if(waterLevels.find(key) != waterLevels.end())
-        return false;
-    int h = getTerrainHeightAt(bx, bz);
-    return (by >= 0 && by <= h);
+// Projection * view of the world pass, from the player's eyes.
+static Mat4 worldViewProjection(const Camera &camera) {
+    Vec3 eyePos = camera.position; eyePos.y += 1.6f;
+    Vec3 viewDir = { cosf(camera.yaw)*cosf(camera.pitch),
+                     sinf(camera.pitch),
+                     sinf(camera.yaw)*cosf(camera.pitch) };
+    Mat4 view = lookAtMatrix(eyePos, add(eyePos, viewDir), {0,1,0});
+    return multiplyMatrix(worldProjection(), view);
 }
 
 static bool checkCollision(const Vec3 &pos) {
+    PROFILE_ZONE("checkCollision");
     float half = playerWidth * 0.5f;
     float minX = pos.x - half, maxX = pos.x + half;
     float minY = pos.y, maxY = pos.y + playerHeight;
@@ -294,8 +334,7 @@ static bool checkCollision(const Vec3 &pos) {
 }
 
 bool canWaterFlowInto(int x, int y, int z) {
-    std::tuple<int,int,int> key = {x, y, z};
-    if(extraBlocks.find(key) != extraBlocks.end())
+    if(extraBlocks.find(packBlockKey(x, y, z)) != extraBlocks.end())
         return false;
     Biome b = getBiome(x, z);
     if(b != BIOME_OCEAN) {
@@ -306,8 +345,6 @@ bool canWaterFlowInto(int x, int y, int z) {
     return true;
 }
 
-static void rebuildChunk(int cx, int cz);
-
 void adjustPlayerSpawn(Camera &camera) {
     while(checkCollision(camera.position)) {
         camera.position.y += 0.5f;
@@ -323,30 +360,33 @@ void adjustPlayerSpawn(Camera &camera) {
 
 static const int NEAR_CHUNK_RADIUS = 2;
 static void updateWaterFlow(const Camera &camera, float /*dt*/) {
+    PROFILE_ZONE("updateWaterFlow");
     int playerChunkX = (int)std::floor(camera.position.x / (float)chunkSize);
     int playerChunkZ = (int)std::floor(camera.position.z / (float)chunkSize);
-    std::vector<std::tuple<int,int,int>> waterKeys;
+    std::vector<uint64_t> waterKeys;
     for(auto &entry : waterLevels)
         waterKeys.push_back(entry.first);
-    for(auto key : waterKeys) {
+    g_perf.activeWaterCells = 0;
+    for(uint64_t key : waterKeys) {
         int x, y, z;
-        std::tie(x, y, z) = key;
+        unpackBlockKey(key, x, y, z);
         int cellChunkX = x / 16; if(x < 0 && x % 16 != 0) cellChunkX--;
         int cellChunkZ = z / 16; if(z < 0 && z % 16 != 0) cellChunkZ--;
         if (std::abs(cellChunkX - playerChunkX) > NEAR_CHUNK_RADIUS ||
             std::abs(cellChunkZ - playerChunkZ) > NEAR_CHUNK_RADIUS)
             continue;
+        g_perf.activeWaterCells++;
         int level = waterLevels[key];
         if(y > 0 && canWaterFlowInto(x, y - 1, z)) {
-            std::tuple<int,int,int> below = {x, y - 1, z};
+            uint64_t below = packBlockKey(x, y - 1, z);
             int belowLevel = 0;
             if(waterLevels.find(below) != waterLevels.end())
                 belowLevel = waterLevels[below];
             if(8 > belowLevel) {
-                waterLevels[below] = 8;
-                int cx = x / 16; if(x < 0 && x % 16 != 0) cx--;
-                int cz = z / 16; if(z < 0 && z % 16 != 0) cz--;
-                rebuildChunk(cx, cz);
+                setWaterLevel(x, y - 1, z, 8);
+                // Neighbouring water hides faces, so sections across a
+                // border need their side of the seam rebuilt too.
+                remeshMarkBlock(x, y - 1, z);
             }
         }
         if(level > 1) {
@@ -357,195 +397,417 @@ static void updateWaterFlow(const Camera &camera, float /*dt*/) {
                 int nz = z + offsets[i][2];
                 if(!canWaterFlowInto(nx, ny, nz))
                     continue;
-                std::tuple<int,int,int> neighbor = {nx, ny, nz};
+                uint64_t neighbor = packBlockKey(nx, ny, nz);
                 int neighborLevel = 0;
                 if(waterLevels.find(neighbor) != waterLevels.end())
                     neighborLevel = waterLevels[neighbor];
                 int newLevel = level - 1;
                 if(newLevel > neighborLevel && newLevel > 1) {
-                    waterLevels[neighbor] = newLevel;
-                    int cx = nx / 16; if(nx < 0 && nx % 16 != 0) cx--;
-                    int cz = nz / 16; if(nz < 0 && nz % 16 != 0) cz--;
-                    rebuildChunk(cx, cz);
+                    setWaterLevel(nx, ny, nz, newLevel);
+                    remeshMarkBlock(nx, ny, nz);
                 }
             }
         }
     }
 }
 
-static Chunk generateChunk(int cx, int cz) {
-    Chunk chunk;
+// Creates a VAO and vertex buffer for a chunk mesh (position + UV).
+static void createMeshBuffers(GLuint &VAO, GLuint &VBO) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3*sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+// Upload target for a section's new mesh: updates its draw state and
+// returns its vertex buffer, creating the VAO on first use.
+static GLuint sectionUploadTarget(int cx, int sy, int cz,
+                                  const GLsizei layerVertices[RENDER_LAYER_COUNT]) {
+    auto it = chunks.find(packChunkKey(cx, cz));
+    if(it == chunks.end() || sy >= (int)it->second.sections.size())
+        return 0;
+    ChunkSection &section = it->second.sections[sy];
+    GLsizei vertexCount = 0;
+    for(int l = 0; l < RENDER_LAYER_COUNT; l++) {
+        section.layerVertices[l] = layerVertices[l];
+        vertexCount += layerVertices[l];
+    }
+    if(!vertexCount)
+        return 0;
+    if(!section.VAO)
+        createMeshBuffers(section.VAO, section.VBO);
+    return section.VBO;
+}
+
+// The chunk's columns, unpacking them first if the chunk was cold.
+static ChunkColumns &chunkColumns(Chunk &chunk) {
+    if(!chunk.columns) {
+        chunk.columns.reset(new ChunkColumns);
+        unpackChunkColumns(chunk.packed, *chunk.columns);
+        chunk.packed = PackedColumns();
+    }
+    return *chunk.columns;
+}
+
+// Packs the columns of every chunk more than COLD_CHUNK_MARGIN chunks
+// beyond renderDistance of chunk (pcx, pcz).
+static void packColdChunks(int pcx, int pcz) {
+    PROFILE_ZONE("packColdChunks");
+    int coldDistance = renderDistance + COLD_CHUNK_MARGIN;
+    for(auto &entry : chunks) {
+        Chunk &chunk = entry.second;
+        if(!chunk.columns ||
+           (std::abs(chunk.chunkX - pcx) <= coldDistance &&
+            std::abs(chunk.chunkZ - pcz) <= coldDistance))
+            continue;
+        if(packChunkColumns(*chunk.columns, chunk.packed))
+            chunk.columns.reset();
+    }
+}
+
+static void meshSection(Chunk &chunk, int sy) {
+    uint64_t meshStart = profilerNowNs();
+    LayeredMesh &mesh = threadLayeredMesh();
+    unsigned long long growths = mesh.growths();
+    chunk.sections[sy].fill = buildSectionMesh(chunkColumns(chunk), sy, mesh);
+    g_perf.meshMs += (profilerNowNs() - meshStart) / 1.0e6f;
+    g_perf.meshArenaGrowths += (int)(mesh.growths() - growths);
+    uploadQueueSection(chunk.chunkX, sy, chunk.chunkZ, mesh);
+    chunk.occludersStale = true;
+}
+
+// Generates chunk (cx, cz) in place in `chunks` and queues its meshes.
+static void generateChunk(int cx, int cz) {
+    PROFILE_ZONE("generateChunk");
+    g_perf.chunksGenerated++;
+    Chunk &chunk = chunks[packChunkKey(cx, cz)];
+    sectionOrderStale = true;
     chunk.chunkX = cx;
     chunk.chunkZ = cz;
-    std::vector<float> verts;
-    verts.reserve(16 * 16 * 36 * 5);
-    unsigned int chunkSeed = (unsigned int)(cx * 73856093u ^ cz * 19349663u);
-    Biome chunkBiome = getBiome(cx * 16 + 8, cz * 16 + 8);
-    if(chunkBiome == BIOME_OCEAN) {
-        const int oceanWaterLayers = 6;
-        for(int y = 0; y < oceanWaterLayers; y++){
-            addCube(verts, (float)(cx*16 + 0), (float)y, (float)(cz*16 + 0), BLOCK_WATER, false);
-        }
+    chunk.occludersStale = true;
+
+    uint64_t genStart = profilerNowNs();
+    ChunkFeatures features;
+    populateChunk(cx, cz, features);
+    applyChunkFeatures(features);
+    chunk.columns.reset(new ChunkColumns);
+    sampleChunkColumns(cx, cz, *chunk.columns);
+    g_perf.genMs += (profilerNowNs() - genStart) / 1.0e6f;
+
+    chunk.sections.resize(chunkSectionCount(*chunk.columns), ChunkSection{SECTION_EMPTY, {0, 0, 0}, 0, 0});
+    for(int sy = 0; sy < (int)chunk.sections.size(); sy++)
+        meshSection(chunk, sy);
+
+    // Tree canopies can reach into neighbouring chunks; remesh the
+    // sections of those that are already loaded so the leaves show up.
+    for(const auto &b : features.blocks) {
+        int ncx, ncz;
+        getChunkCoords(std::get<0>(b.first), std::get<2>(b.first), ncx, ncz);
+        if((ncx != cx || ncz != cz) && isChunkLoaded(ncx, ncz))
+            remeshMarkSection(ncx, getSectionY(std::get<1>(b.first)), ncz);
     }
-    for(int lx = 0; lx < 16; lx++){
-        for(int lz = 0; lz < 16; lz++){
-            int wx = cx * 16 + lx;
-            int wz = cz * 16 + lz;
-            Biome b = getBiome(wx, wz);
-            if(b == BIOME_OCEAN) {
-                const int oceanWaterLayers = 6;
-                for(int y = 0; y < oceanWaterLayers; y++){
-                    addCube(verts, (float)wx, (float)y, (float)wz, BLOCK_WATER, false);
-                    waterLevels[{wx, y, wz}] = 8;
-                }
-                addCube(verts, (float)wx, (float)oceanWaterLayers, (float)wz, BLOCK_SAND, false);
-                addCube(verts, (float)wx, (float)(oceanWaterLayers + 1), (float)wz, BLOCK_BEDROCK, false);
-            } else {
-                int height = getTerrainHeightAt(wx, wz);
-                for(int y = 0; y <= height; y++){
-                    BlockType type;
-                    if(b == BIOME_DESERT){
-                        const int sandLayers = 2, dirtLayers = 3;
-                        if(y >= height - sandLayers)
-                            type = BLOCK_SAND;
-                        else if(y >= height - (sandLayers + dirtLayers))
-                            type = BLOCK_DIRT;
-                        else
-                            type = BLOCK_STONE;
-                    } else {
-                        if(y == height)
-                            type = BLOCK_GRASS;
-                        else if((height - y) <= 6)
-                            type = BLOCK_DIRT;
-                        else
-                            type = BLOCK_STONE;
-                    }
-                    addCube(verts, (float)wx, (float)y, (float)wz, type, true);
-                }
-                int chance = 0;
-                if(b == BIOME_FOREST) chance = 5;
-                else if(b == BIOME_PLAINS) chance = 50;
-                else if(b == BIOME_EXTREME_HILLS) chance = 80;
-                if(chance > 0 && (rand() % chance == 0)) {
-                    int trunkH = 4 + (rand() % 3);
-                    int baseY = height + 1;
-                    for(int ty = baseY; ty < baseY + trunkH; ty++){
-                        addCube(verts, (float)wx, (float)ty, (float)wz, BLOCK_TREE_LOG, true);
-                        extraBlocks[{wx, ty, wz}] = BLOCK_TREE_LOG;
-                    }
-                    int topY = baseY + trunkH - 1;
-                    for(int lx2 = wx - 1; lx2 <= wx + 1; lx2++){
-                        for(int lz2 = wz - 1; lz2 <= wz + 1; lz2++){
-                            if(lx2 == wx && lz2 == wz)
-                                continue;
-                            addCube(verts, (float)lx2, (float)topY, (float)lz2, BLOCK_LEAVES, false);
-                            extraBlocks[{lx2, topY, lz2}] = BLOCK_LEAVES;
-                        }
-                    }
-                    addCube(verts, (float)wx, (float)(topY + 1), (float)wz, BLOCK_LEAVES, false);
-                    extraBlocks[{wx, topY + 1, wz}] = BLOCK_LEAVES;
-                }
+}
+
+static void rebuildSection(int cx, int sy, int cz) {
+    auto it = chunks.find(packChunkKey(cx, cz));
+    if(it == chunks.end() || sy < 0)
+        return;
+    PROFILE_ZONE("rebuildSection");
+    g_perf.chunksRebuilt++;
+    Chunk &chunk = it->second;
+    if(sy >= (int)chunk.sections.size()) {
+        chunk.sections.resize(sy + 1, ChunkSection{SECTION_EMPTY, {0, 0, 0}, 0, 0});
+        sectionOrderStale = true;
+    }
+    meshSection(chunk, sy);
+}
+
+// LOD step for a chunk `d` chunks from the player's, or 0 beyond the
+// outermost ring.
+static int lodStepAt(int d) {
+    for(const LodLevel &level : LOD_LEVELS)
+        if(d <= renderDistance + level.rings)
+            return level.step;
+    return 0;
+}
+
+// Builds the LOD mesh of chunk (cx, cz) and queues it for upload. Until
+// it is written, the chunk keeps drawing its previous LOD mesh, if any.
+static void buildLodChunk(int cx, int cz, int step) {
+    MeshArena &arena = threadMeshArena();
+    unsigned long long growths = arena.growths;
+    uint64_t meshStart = profilerNowNs();
+    buildLodMesh(cx, cz, step, arena);
+    g_perf.meshMs += (profilerNowNs() - meshStart) / 1.0e6f;
+    g_perf.meshArenaGrowths += (int)(arena.growths - growths);
+    LodChunk &lod = lodChunks[packChunkKey(cx, cz)];
+    if(!lod.VAO) {
+        createMeshBuffers(lod.VAO, lod.VBO);
+        lodOrderStale = true;
+    }
+    lod.chunkX = cx;
+    lod.chunkZ = cz;
+    lod.step = step;
+    uploadQueueLod(cx, cz, arena);
+}
+
+// Upload target for a chunk's new LOD mesh.
+static GLuint lodUploadTarget(int cx, int cz, GLsizei vertexCount) {
+    auto it = lodChunks.find(packChunkKey(cx, cz));
+    if(it == lodChunks.end())
+        return 0;
+    it->second.vertexCount = vertexCount;
+    return vertexCount ? it->second.VBO : 0;
+}
+
+// Drops LOD meshes that left the rings or whose full-resolution chunk is
+// loaded with all its section meshes uploaded, then builds missing ones
+// and ones at the wrong step, nearest ring first.
+static void updateLodChunks(int pcx, int pcz) {
+    PROFILE_ZONE("updateLodChunks");
+    std::vector<uint64_t> drop;
+    for(auto &entry : lodChunks) {
+        const LodChunk &lod = entry.second;
+        int d = std::max(std::abs(lod.chunkX - pcx), std::abs(lod.chunkZ - pcz));
+        if(d > renderDistance + LOD_RINGS ||
+           (d <= renderDistance && isChunkLoaded(lod.chunkX, lod.chunkZ) &&
+            !uploadChunkPending(lod.chunkX, lod.chunkZ)))
+            drop.push_back(entry.first);
+    }
+    for(uint64_t key : drop) {
+        LodChunk &lod = lodChunks.find(key)->second;
+        glDeleteVertexArrays(1, &lod.VAO);
+        glDeleteBuffers(1, &lod.VBO);
+        lodChunks.erase(key);
+        lodOrderStale = true;
+    }
+
+    int built = 0;
+    for(int d = renderDistance + 1; d <= renderDistance + LOD_RINGS; d++) {
+        int step = lodStepAt(d);
+        for(int cx = pcx - d; cx <= pcx + d; cx++) {
+            for(int cz = pcz - d; cz <= pcz + d; cz++) {
+                if(std::abs(cx - pcx) != d && std::abs(cz - pcz) != d)
+                    continue;
+                auto it = lodChunks.find(packChunkKey(cx, cz));
+                if(it != lodChunks.end() && it->second.step == step)
+                    continue;
+                if(built++ == LOD_CHUNKS_PER_FRAME)
+                    return;
+                buildLodChunk(cx, cz, step);
             }
         }
     }
-    chunk.vertices = verts;
-    glGenVertexArrays(1, &chunk.VAO);
-    glGenBuffers(1, &chunk.VBO);
-    glBindVertexArray(chunk.VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3*sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-    return chunk;
 }
 
-static void getChunkCoords(int bx, int bz, int &cx, int &cz) {
-    cx = bx / 16; if(bx < 0 && bx % 16 != 0) cx--;
-    cz = bz / 16; if(bz < 0 && bz % 16 != 0) cz--;
+// Makes a world shader program current with this frame's uniforms.
+static void useWorldShader(GLuint program, const Mat4 &pv, const Vec3 &viewPos) {
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "MVP"), 1, GL_FALSE, pv.m);
+    glUniform1i(glGetUniformLocation(program, "ourTexture"), 0);
+    // Set directional light and view position for realistic lighting.
+    Vec3 sunDir = normalize({0.3f, 1.0f, 0.3f});
+    glUniform3f(glGetUniformLocation(program, "sunDirection"), sunDir.x, sunDir.y, sunDir.z);
+    glUniform3f(glGetUniformLocation(program, "viewPos"), viewPos.x, viewPos.y, viewPos.z);
 }
 
-static void rebuildChunk(int cx, int cz) {
-    Chunk &chunk = chunks[{cx, cz}];
-    std::vector<float> verts;
-    verts.reserve(16 * 16 * 36 * 5);
-    
-    for (int lx = 0; lx < 16; lx++){
-        for (int lz = 0; lz < 16; lz++){
-            int wx = cx * 16 + lx;
-            int wz = cz * 16 + lz;
-            Biome b = getBiome(wx, wz);
-            if(b == BIOME_OCEAN) {
-                const int oceanWaterLayers = 6;
-                for (int y = 0; y < oceanWaterLayers; y++){
-                    addCube(verts, (float)wx, (float)y, (float)wz, BLOCK_WATER, false);
-                    waterLevels[{wx, y, wz}] = 8;
-                }
-                addCube(verts, (float)wx, (float)oceanWaterLayers, (float)wz, BLOCK_SAND, false);
-                addCube(verts, (float)wx, (float)(oceanWaterLayers + 1), (float)wz, BLOCK_BEDROCK, false);
-            } else {
-                int height = getTerrainHeightAt(wx, wz);
-                for (int y = 0; y <= height; y++){
-                    std::tuple<int,int,int> key = {wx, y, wz};
-                    if (waterLevels.find(key) != waterLevels.end()){
-                        addCube(verts, (float)wx, (float)y, (float)wz, BLOCK_WATER, true);
-                        continue;
-                    }
-                    auto it = extraBlocks.find(key);
-                    if (it != extraBlocks.end()){
-                        BlockType ov = it->second;
-                        if ((int)ov < 0) continue;
-                        addCube(verts, (float)wx, (float)y, (float)wz, ov, true);
-                    } else {
-                        BlockType terr;
-                        if(b == BIOME_DESERT){
-                            const int sandLayers = 2, dirtLayers = 3;
-                            if(y >= height - sandLayers)
-                                terr = BLOCK_SAND;
-                            else if(y >= height - (sandLayers + dirtLayers))
-                                terr = BLOCK_DIRT;
-                            else
-                                terr = BLOCK_STONE;
-                        } else {
-                            if(y == height)
-                                terr = BLOCK_GRASS;
-                            else if((height - y) <= 6)
-                                terr = BLOCK_DIRT;
-                            else
-                                terr = BLOCK_STONE;
-                        }
-                        addCube(verts, (float)wx, (float)y, (float)wz, terr, true);
-                    }
-                }
-                for (int y = height + 1; y < height + 20; y++){
-                    std::tuple<int,int,int> key = {wx, y, wz};
-                    if (extraBlocks.find(key) != extraBlocks.end()){
-                        BlockType ov = extraBlocks[key];
-                        if ((int)ov < 0) continue;
-                        addCube(verts, (float)wx, (float)y, (float)wz, ov, true);
-                    }
-                }
+// Draw order of the sections within renderDistance and of the LOD meshes,
+// nearest first, by squared distance in sections (chunks for LOD) from
+// the eye's section. It only changes when the eye moves into another
+// section or its stale flag is set, so it is kept from frame to frame.
+struct OrderedSection {
+    int distance;
+    const ChunkSection *section;
+    OcclusionBox box;
+};
+
+struct OrderedLod {
+    int distance;
+    const LodChunk *lod;
+};
+
+static std::vector<OrderedSection> sectionOrder;
+static std::vector<OrderedLod> lodOrder;
+static std::vector<uint8_t> sectionDrawn;   // drawWorld() scratch
+static int orderedChunks = 0;   // chunks the sections in sectionOrder belong to
+static int orderX, orderY, orderZ;
+static unsigned sectionOrderVersion = 0;   // bumped by every sectionOrder rebuild
+
+// Section y of the player's eyes.
+static int eyeSectionY(const Camera &camera) {
+    return (int)std::floor((camera.position.y + 1.6f) / (float)chunkSize);
+}
+
+static void buildSectionOrder(int ex, int ey, int ez) {
+    PROFILE_ZONE("buildSectionOrder");
+    sectionOrder.clear();
+    orderedChunks = 0;
+    for(auto &pair : chunks) {
+        const Chunk &ch = pair.second;
+        int dx = ch.chunkX - ex, dz = ch.chunkZ - ez;
+        if(std::abs(dx) > renderDistance || std::abs(dz) > renderDistance)
+            continue;
+        for(int sy = 0; sy < (int)ch.sections.size(); sy++) {
+            // Sections without a mesh yet stay in: drawSectionLayer()
+            // skips them, and their first upload doesn't reorder.
+            const ChunkSection &sec = ch.sections[sy];
+            int dy = sy - ey;
+            Vec3 lo = { ch.chunkX * (float)chunkSize, sy * (float)chunkSize, ch.chunkZ * (float)chunkSize };
+            Vec3 hi = { lo.x + chunkSize, lo.y + chunkSize, lo.z + chunkSize };
+            sectionOrder.push_back(OrderedSection{ dx*dx + dy*dy + dz*dz, &sec, OcclusionBox{ lo, hi } });
+        }
+        orderedChunks++;
+    }
+    std::sort(sectionOrder.begin(), sectionOrder.end(),
+              [](const OrderedSection &a, const OrderedSection &b) { return a.distance < b.distance; });
+    sectionOrderStale = false;
+    sectionOrderVersion++;
+}
+
+static void buildLodOrder(int ex, int ez) {
+    PROFILE_ZONE("buildLodOrder");
+    lodOrder.clear();
+    for(auto &pair : lodChunks) {
+        const LodChunk &lod = pair.second;
+        int dx = lod.chunkX - ex, dz = lod.chunkZ - ez;
+        lodOrder.push_back(OrderedLod{ dx*dx + dz*dz, &lod });
+    }
+    std::sort(lodOrder.begin(), lodOrder.end(),
+              [](const OrderedLod &a, const OrderedLod &b) { return a.distance < b.distance; });
+    lodOrderStale = false;
+}
+
+static void updateDrawOrder(const Camera &camera, int pcx, int pcz) {
+    int pcy = eyeSectionY(camera);
+    bool moved = pcx != orderX || pcy != orderY || pcz != orderZ;
+    if(sectionOrderStale || moved)
+        buildSectionOrder(pcx, pcy, pcz);
+    if(lodOrderStale || moved)
+        buildLodOrder(pcx, pcz);
+    orderX = pcx;
+    orderY = pcy;
+    orderZ = pcz;
+}
+
+// Occlusion culling of the draw order runs on the worker (see occlusion.h)
+// while the rest of the frame's CPU work happens; drawWorld() waits for it
+// and uses the result if the draw order hasn't been rebuilt since.
+static bool occlusionEnabled = true;
+static bool occlusionPending = false;
+static unsigned occlusionOrderVersion = 0;
+static std::vector<OcclusionBox> occluderScratch, queryScratch;
+
+static void submitOcclusion(const Mat4 &pv, const Camera &camera, int pcx, int pcz) {
+    PROFILE_ZONE("submitOcclusion");
+    updateDrawOrder(camera, pcx, pcz);
+    occluderScratch.clear();
+    for(int cx = pcx - OCCLUDER_RADIUS; cx <= pcx + OCCLUDER_RADIUS; cx++) {
+        for(int cz = pcz - OCCLUDER_RADIUS; cz <= pcz + OCCLUDER_RADIUS; cz++) {
+            auto it = chunks.find(packChunkKey(cx, cz));
+            if(it == chunks.end())
+                continue;
+            // Until its meshes are all uploaded, the terrain of a chunk
+            // may not be on screen to hide anything.
+            if(uploadChunkPending(cx, cz))
+                continue;
+            Chunk &chunk = it->second;
+            if(chunk.occludersStale) {
+                chunk.occluders.clear();
+                buildChunkOccluders(chunkColumns(chunk), chunk.occluders);
+                chunk.occludersStale = false;
             }
+            occluderScratch.insert(occluderScratch.end(), chunk.occluders.begin(), chunk.occluders.end());
         }
     }
-    
-    for (auto &kv : waterLevels){
-        int bx = std::get<0>(kv.first);
-        int by = std::get<1>(kv.first);
-        int bz = std::get<2>(kv.first);
-        int ccx, ccz;
-        getChunkCoords(bx, bz, ccx, ccz);
-        if(ccx == cx && ccz == cz)
-            addCube(verts, (float)bx, (float)by, (float)bz, BLOCK_WATER, true);
+    queryScratch.clear();
+    for(const OrderedSection &o : sectionOrder)
+        queryScratch.push_back(o.box);
+    occlusionSubmit(pv, occluderScratch, queryScratch);
+    occlusionPending = true;
+    occlusionOrderVersion = sectionOrderVersion;
+}
+
+static void drawSectionLayer(const ChunkSection &sec, RenderLayer layer) {
+    GLsizei count = sec.layerVertices[layer];
+    if(!count) return;
+    GLint first = 0;
+    for(int l = 0; l < layer; l++)
+        first += sec.layerVertices[l];
+    glBindVertexArray(sec.VAO);
+    glDrawArrays(GL_TRIANGLES, first, count);
+    g_perf.drawCalls++;
+    g_perf.verticesSubmitted += count;
+}
+
+// Draws the loaded chunks within renderDistance and the LOD meshes in the
+// view frustum, in three passes:
+//  - opaque sections nearest first, then the LOD meshes (all farther), so
+//    hidden fragments fail the depth test before they are shaded; no
+//    blending and no alpha test,
+//  - cutout faces (leaves, glass) with the alpha test, unblended,
+//  - translucent faces (water) farthest section first, blended, so each
+//    blends over what is already behind it. Depth writes stay on, so only
+//    the nearest surface of a body of water shows.
+// Sections found hidden by a submitted occlusion job are skipped.
+// The texture is bound by the caller; worldShader is current afterwards.
+static void drawWorld(const Mat4 &pv, const Camera &camera, int pcx, int pcz) {
+    PROFILE_ZONE("draw chunks");
+    updateDrawOrder(camera, pcx, pcz);
+    g_perf.visibleChunks += orderedChunks;
+    // One flag per entry of sectionOrder.
+    std::vector<uint8_t> &drawn = sectionDrawn;
+    drawn.assign(sectionOrder.size(), 1);
+    if(occlusionPending) {
+        const std::vector<uint8_t> &visible = occlusionWait();
+        occlusionPending = false;
+        if(occlusionOrderVersion == sectionOrderVersion) {
+            drawn = visible;
+            for(uint8_t v : visible)
+                g_perf.culledSections += !v;
+        }
     }
-    
-    chunk.vertices = verts;
-    glBindVertexArray(chunk.VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
-    glBindVertexArray(0);
+
+    glDisable(GL_BLEND);
+    useWorldShader(worldOpaqueShader, pv, camera.position);
+    for(size_t i = 0; i < sectionOrder.size(); i++)
+        if(drawn[i]) drawSectionLayer(*sectionOrder[i].section, LAYER_OPAQUE);
+    Frustum view = frustumFromMatrix(pv);
+    for(const OrderedLod &o : lodOrder) {
+        const LodChunk &lod = *o.lod;
+        Vec3 boxMin = { lod.chunkX * (float)chunkSize, 0.0f, lod.chunkZ * (float)chunkSize };
+        Vec3 boxMax = { boxMin.x + chunkSize, LOD_BOX_TOP, boxMin.z + chunkSize };
+        if(!lod.vertexCount || !frustumIntersectsBox(view, boxMin, boxMax))
+            continue;
+        glBindVertexArray(lod.VAO);
+        glDrawArrays(GL_TRIANGLES, 0, lod.vertexCount);
+        g_perf.drawCalls++;
+        g_perf.verticesSubmitted += lod.vertexCount;
+        g_perf.visibleLodChunks++;
+    }
+
+    useWorldShader(worldShader, pv, camera.position);
+    for(size_t i = 0; i < sectionOrder.size(); i++)
+        if(drawn[i]) drawSectionLayer(*sectionOrder[i].section, LAYER_CUTOUT);
+
+    glEnable(GL_BLEND);
+    for(size_t i = sectionOrder.size(); i-- > 0;)
+        if(drawn[i]) drawSectionLayer(*sectionOrder[i].section, LAYER_TRANSLUCENT);
+}
+
+// Remeshes every section of a loaded chunk, e.g. after loading a world
+// whose edits may reach above the sections it had.
+static void rebuildChunk(int cx, int cz) {
+    auto it = chunks.find(packChunkKey(cx, cz));
+    if(it == chunks.end())
+        return;
+    int count = std::max(chunkSectionCount(chunkColumns(it->second)), (int)it->second.sections.size());
+    for(int sy = 0; sy < count; sy++)
+        rebuildSection(cx, sy, cz);
 }
 
 // -----------------------------------------------------------------------------
@@ -594,75 +856,28 @@ void main(){
     vec3 lighting = ambient + diffuse + specular;
     
     vec4 texColor = texture(ourTexture, TexCoord);
+#ifndef OPAQUE_PASS
     if(texColor.a < 0.1)
         discard;
+#endif
     
     FragColor = vec4(texColor.rgb * lighting, texColor.a);
 }
 )";
 
-static const char* uiVertSrc = R"(
-#version 330 core
-layout(location=0) in vec2 aPos;
-uniform mat4 uProj;
-void main(){
-    gl_Position = uProj * vec4(aPos, 0.0, 1.0);
-}
-)";
-
-static const char* uiFragSrc = R"(
-#version 330 core
-out vec4 FragColor;
-uniform vec4 uColor;
-void main(){
-    FragColor = uColor;
-}
-)";
-
-static void initUI() {
-    uiShader = createShaderProgram(uiVertSrc, uiFragSrc);
-    glGenVertexArrays(1, &uiVAO);
-    glGenBuffers(1, &uiVBO);
-    glBindVertexArray(uiVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float)*12, nullptr, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
+// `source` with `#define name` inserted after its #version line.
+static std::string shaderWithDefine(const char* source, const char* name) {
+    std::string s = source;
+    size_t line = s.find('\n', s.find("#version")) + 1;
+    return s.insert(line, std::string("#define ") + name + "\n");
 }
 
 int drawPauseMenu(int screenW, int screenH) {
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glUseProgram(uiShader);
-    float overlayVerts[12] = { 0, 0, (float)screenW, 0, (float)screenW, (float)screenH,
-                               0, 0, (float)screenW, (float)screenH, 0, (float)screenH };
-    glBindVertexArray(uiVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(overlayVerts), overlayVerts);
-    Mat4 proj = {};
-    proj.m[0]  = 2.0f/(float)screenW;
-    proj.m[5]  = 2.0f/(float)screenH;
-    proj.m[10] = -1.0f;
-    proj.m[15] = 1.0f;
-    proj.m[12] = -1.0f;
-    proj.m[13] = -1.0f;
-    glUniformMatrix4fv(glGetUniformLocation(uiShader, "uProj"), 1, GL_FALSE, proj.m);
-    glUniform4f(glGetUniformLocation(uiShader, "uColor"), 0.0f, 0.0f, 0.0f, 0.5f);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    uiRect(0, 0, (float)screenW, (float)screenH, 0.0f, 0.0f, 0.0f, 0.5f);
     float resumeX = 300, resumeY = 250, resumeW = 200, resumeH = 50;
-    float resumeVerts[12] = { resumeX, resumeY, resumeX+resumeW, resumeY, resumeX+resumeW, resumeY+resumeH,
-                              resumeX, resumeY, resumeX+resumeW, resumeY+resumeH, resumeX, resumeY+resumeH };
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(resumeVerts), resumeVerts);
-    glUniform4f(glGetUniformLocation(uiShader, "uColor"), 0.2f, 0.6f, 1.0f, 1.0f);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    uiRect(resumeX, resumeY, resumeW, resumeH, 0.2f, 0.6f, 1.0f, 1.0f);
     float quitX = 300, quitY = 150, quitW = 200, quitH = 50;
-    float quitVerts[12] = { quitX, quitY, quitX+quitW, quitY, quitX+quitW, quitY+quitH,
-                            quitX, quitY, quitX+quitW, quitY+quitH, quitX, quitY+quitH };
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(quitVerts), quitVerts);
-    glUniform4f(glGetUniformLocation(uiShader, "uColor"), 1.0f, 0.3f, 0.3f, 1.0f);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    uiRect(quitX, quitY, quitW, quitH, 1.0f, 0.3f, 0.3f, 1.0f);
     int mx, my;
     Uint32 mState = SDL_GetMouseState(&mx, &my);
     bool leftDown = (mState & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
@@ -674,154 +889,320 @@ int drawPauseMenu(int screenW, int screenH) {
         else if(mx >= quitX && mx <= quitX+quitW && invY >= quitY && invY <= quitY+quitH)
             result = 2;
     }
-    glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
     return result;
 }
 
-void drawFlyIndicator(bool isFlying, int screenW, int screenH) {
+void drawFlyIndicator(bool isFlying, int /*screenW*/, int screenH) {
     float w = 20.0f, h = 20.0f, x = 5.0f, y = (float)screenH - h - 5.0f;
     float r = isFlying ? 0.1f : 1.0f;
     float g = isFlying ? 1.0f : 0.0f;
     float b = isFlying ? 0.1f : 0.0f;
-    glDisable(GL_DEPTH_TEST);
-    glUseProgram(uiShader);
-    float verts[12] = { x, y, x+w, y, x+w, y+h, x, y, x+w, y+h, x, y+h };
-    glBindVertexArray(uiVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
-    Mat4 proj = {};
-    proj.m[0]  = 2.0f/(float)screenW;
-    proj.m[5]  = 2.0f/(float)screenH;
-    proj.m[10] = -1.0f;
-    proj.m[15] = 1.0f;
-    proj.m[12] = -1.0f;
-    proj.m[13] = -1.0f;
-    glUniformMatrix4fv(glGetUniformLocation(uiShader, "uProj"), 1, GL_FALSE, proj.m);
-    glUniform4f(glGetUniformLocation(uiShader, "uColor"), r, g, b, 1.0f);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glEnable(GL_DEPTH_TEST);
+    uiRect(x, y, w, h, r, g, b, 1.0f);
+}
+
+static HudWorldInfo hudWorldInfo() {
+    HudWorldInfo info;
+    info.loadedChunks = chunks.size();
+    info.packedChunks = 0;
+    info.columnBytes = 0;
+    for(auto &entry : chunks) {
+        const Chunk &chunk = entry.second;
+        if(chunk.columns) {
+            info.columnBytes += sizeof(ChunkColumns);
+        }
+        else {
+            info.packedChunks++;
+            info.columnBytes += packedColumnsBytes(chunk.packed);
+        }
+    }
+    info.extraBlocks = extraBlocks.size();
+    info.waterLevels = waterLevels.size();
+    return info;
 }
 
 void drawFirstPersonHand3D(int screenW, int screenH, const Mat4 &proj) {
     // (Unused in the new approach)
 }
 
-int main(int /*argc*/, char* /*argv*/[]) {
+static void shutdownVideo(SDL_Window* window, SDL_GLContext glContext) {
+    headlessShutdown();
+    if(glContext) SDL_GL_DeleteContext(glContext);
+    if(window) SDL_DestroyWindow(window);
+    SDL_Quit();
+}
+
+int main(int argc, char* argv[]) {
+    // --profile[=file]: capture profiler zones from startup and write a
+    // Chrome trace on exit. F9 toggles capture at runtime; stopping it
+    // writes the trace as well.
+    //
+    // --record=<file> / --replay=<file>: record input to, or replay it
+    // from, a file (see replay.h). --seed=<n> picks the world seed for a
+    // recording. --timings[=<file>] writes per-frame timings as CSV; it is
+    // on by default (timings.csv) when replaying.
+    //
+    // --headless: render offscreen through EGL with no window (see
+    // headless.h). Without --replay the simulation steps at a fixed 60 Hz.
+    // --frames=<n> stops after n frames; --screenshot=<file.ppm> saves the
+    // last headless frame for image comparisons.
+    //
+    // --upload-budget=<KiB>: mesh data uploaded to the GPU per frame
+    // (default 1024, see upload.h).
+    //
+    // --render-distance=<chunks>: fix the full-resolution render distance
+    // instead of adapting it. --frame-target=<ms>: frame time the adaptive
+    // render distance aims for (default 16.6).
+    //
+    // --no-occlusion: draw every section in range instead of skipping the
+    // ones the occlusion test finds hidden (see occlusion.h).
+    const char* traceFile = "trace.json";
+    const char* recordFile = nullptr;
+    const char* replayFile = nullptr;
+    const char* timingsFile = nullptr;
+    unsigned int recordSeed = 12345;
+    bool headless = false;
+    long maxFrames = -1;
+    const char* screenshotFile = nullptr;
+    size_t uploadBudgetKiB = 1024;
+    int fixedRenderDistance = 0;
+    float frameTargetMs = 16.6f;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg.compare(0, 9, "--profile") == 0) {
+            profilerSetEnabled(true);
+            if(arg.size() > 10 && arg[9] == '=')
+                traceFile = argv[i] + 10;
+        }
+        else if(arg.compare(0, 9, "--record=") == 0)
+            recordFile = argv[i] + 9;
+        else if(arg.compare(0, 9, "--replay=") == 0)
+            replayFile = argv[i] + 9;
+        else if(arg.compare(0, 7, "--seed=") == 0)
+            recordSeed = (unsigned int)strtoul(argv[i] + 7, nullptr, 10);
+        else if(arg == "--timings")
+            timingsFile = "timings.csv";
+        else if(arg.compare(0, 10, "--timings=") == 0)
+            timingsFile = argv[i] + 10;
+        else if(arg == "--headless")
+            headless = true;
+        else if(arg.compare(0, 9, "--frames=") == 0)
+            maxFrames = strtol(argv[i] + 9, nullptr, 10);
+        else if(arg.compare(0, 13, "--screenshot=") == 0)
+            screenshotFile = argv[i] + 13;
+        else if(arg.compare(0, 16, "--upload-budget=") == 0)
+            uploadBudgetKiB = strtoul(argv[i] + 16, nullptr, 10);
+        else if(arg.compare(0, 18, "--render-distance=") == 0)
+            fixedRenderDistance = std::max(1, atoi(argv[i] + 18));
+        else if(arg.compare(0, 15, "--frame-target=") == 0)
+            frameTargetMs = (float)atof(argv[i] + 15);
+        else if(arg == "--no-occlusion")
+            occlusionEnabled = false;
+    }
+    profilerSetThreadName("main");
     float loadedX = 0.0f, loadedY = 30.0f, loadedZ = 0.0f;
     int loadedSeed = 0;
-    bool loadedOk = loadWorld("saved_world.txt", loadedSeed, loadedX, loadedY, loadedZ);
+    bool loadedOk = false;
+    // Recordings always start from a fresh world so replays match.
+    ReplayStart replayStart = { recordSeed, loadedX, loadedY, loadedZ, -3.14f/2, 0.0f };
+    if(replayFile) {
+        if(!inputStartReplay(replayFile, replayStart))
+            return -1;
+        if(!timingsFile)
+            timingsFile = "timings.csv";
+    }
+    else if(recordFile) {
+        if(!inputStartRecording(recordFile, replayStart))
+            return -1;
+    }
+    bool freshWorld = inputReplaying() || inputRecording() || headless;
+    if(fixedRenderDistance)
+        renderDistance = fixedRenderDistance;
+    bool adaptiveDistance = !fixedRenderDistance && !headless && !inputReplaying();
+    ViewDistanceController viewDistance;
+    viewDistanceInit(viewDistance, renderDistance, MIN_RENDER_DISTANCE,
+                     MAX_RENDER_DISTANCE, frameTargetMs);
+    if(freshWorld) {
+        setNoiseSeed(replayStart.seed);
+        srand(replayStart.seed);
+        loadedSeed = (int)replayStart.seed;
+        loadedX = replayStart.x;
+        loadedY = replayStart.y;
+        loadedZ = replayStart.z;
+    }
+    else
+        loadedOk = loadWorld("saved_world.txt", loadedSeed, loadedX, loadedY, loadedZ);
     if(loadedOk)
         std::cout << "[World] Loaded seed=" << loadedSeed
                   << " player(" << loadedX << "," << loadedY << "," << loadedZ << ")\n";
-    else {
+    else if(!freshWorld) {
         unsigned int rseed = (unsigned int)time(nullptr);
         std::cout << "[World] No saved world, random seed=" << rseed << "\n";
         setNoiseSeed(rseed);
         srand(rseed);
         loadedSeed = (int)rseed;
     }
-    if(SDL_Init(SDL_INIT_VIDEO) < 0) {
-        std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
-        return -1;
-    }
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-    SDL_Window* window = SDL_CreateWindow("Voxel Engine",
-                                          SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                          SCREEN_WIDTH, SCREEN_HEIGHT,
-                                          SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
-    if(!window) {
-        std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << std::endl;
-        SDL_Quit();
-        return -1;
-    }
-    SDL_GLContext glContext = SDL_GL_CreateContext(window);
-    if(!glContext) {
-        std::cerr << "SDL_GL_CreateContext Error: " << SDL_GetError() << std::endl;
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return -1;
+    SDL_Window* window = nullptr;
+    SDL_GLContext glContext = nullptr;
+    if(headless) {
+        // No video subsystem: SDL only provides timing and (empty) input.
+        if(SDL_Init(0) < 0) {
+            std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
+            return -1;
+        }
+        if(!headlessInit()) {
+            SDL_Quit();
+            return -1;
+        }
+    } else {
+        if(SDL_Init(SDL_INIT_VIDEO) < 0) {
+            std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
+            return -1;
+        }
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        window = SDL_CreateWindow("Voxel Engine",
+                                  SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                  SCREEN_WIDTH, SCREEN_HEIGHT,
+                                  SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
+        if(!window) {
+            std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << std::endl;
+            SDL_Quit();
+            return -1;
+        }
+        glContext = SDL_GL_CreateContext(window);
+        if(!glContext) {
+            std::cerr << "SDL_GL_CreateContext Error: " << SDL_GetError() << std::endl;
+            shutdownVideo(window, glContext);
+            return -1;
+        }
     }
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glewExperimental = GL_TRUE;
     GLenum glewErr = glewInit();
+    // GLEW built for GLX reports a missing X display after it has already
+    // loaded the GL entry points, which is all an EGL context needs.
+    if(headless && glewErr == GLEW_ERROR_NO_GLX_DISPLAY)
+        glewErr = GLEW_OK;
     if(glewErr != GLEW_OK) {
         std::cerr << "GLEW Error: " << glewGetErrorString(glewErr) << std::endl;
-        SDL_GL_DeleteContext(glContext);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
+        shutdownVideo(window, glContext);
+        return -1;
+    }
+    if(headless && !headlessCreateTarget(SCREEN_WIDTH, SCREEN_HEIGHT)) {
+        shutdownVideo(window, glContext);
         return -1;
     }
-    SDL_GL_SetSwapInterval(1);
+    // Replays measure how fast frames can be produced, so don't wait for
+    // vsync.
+    if(!headless)
+        SDL_GL_SetSwapInterval(inputReplaying() ? 0 : 1);
     glEnable(GL_DEPTH_TEST);
     worldShader = createShaderProgram(worldVertSrc, worldFragSrc);
+    // A shader that can discard keeps some GPUs from rejecting hidden
+    // fragments before shading them, so opaque faces get a variant without.
+    worldOpaqueShader = createShaderProgram(worldVertSrc,
+        shaderWithDefine(worldFragSrc, "OPAQUE_PASS").c_str());
     texID = loadTexture("texture.png");
     if(!texID) {
         std::cerr << "Texture failed to load!\n";
-        SDL_GL_DeleteContext(glContext);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
+        shutdownVideo(window, glContext);
         return -1;
     }
     handTex = loadTexture("hand.png");
     if(!handTex) {
         std::cerr << "Hand texture failed to load!\n";
-        SDL_GL_DeleteContext(glContext);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
+        shutdownVideo(window, glContext);
         return -1;
     }
-    initUI();
+    uiInit();
+    fontInit();
+    gpuTimersInit();
+    if(occlusionEnabled)
+        occlusionStartWorker();
+    uploadInit(std::max<size_t>(uploadBudgetKiB, 1) * 1024);
     Inventory inventory;
     int spawnChunkX = (int)std::floor(loadedX / (float)chunkSize);
     int spawnChunkZ = (int)std::floor(loadedZ / (float)chunkSize);
-    std::pair<int,int> chunkKey = {spawnChunkX, spawnChunkZ};
-    if(chunks.find(chunkKey) == chunks.end())
-        chunks[chunkKey] = generateChunk(spawnChunkX, spawnChunkZ);
+    if(!isChunkLoaded(spawnChunkX, spawnChunkZ))
+        generateChunk(spawnChunkX, spawnChunkZ);
     Camera camera;
     camera.position = {loadedX, loadedY, loadedZ};
-    camera.yaw = -3.14f/2;
-    camera.pitch = 0.0f;
+    camera.yaw = replayStart.yaw;
+    camera.pitch = replayStart.pitch;
     bool paused = false, isFlying = false;
+    bool showHud = false;
     float verticalVelocity = 0.0f;
     int tickCount = 0;
+    // Player chunk when cold chunks were last packed.
+    int coldCheckX = spawnChunkX, coldCheckZ = spawnChunkZ;
     float tickAccumulator = 0.0f;
     if(loadedOk) {
         int pcx = (int)std::floor(camera.position.x / (float)chunkSize);
         int pcz = (int)std::floor(camera.position.z / (float)chunkSize);
         for(int cx = pcx - renderDistance; cx <= pcx + renderDistance; cx++){
             for(int cz = pcz - renderDistance; cz <= pcz + renderDistance; cz++){
-                std::pair<int,int> cKey = {cx, cz};
-                if(chunks.find(cKey) == chunks.end())
-                    chunks[cKey] = generateChunk(cx, cz);
+                if(!isChunkLoaded(cx, cz))
+                    generateChunk(cx, cz);
                 else
                     rebuildChunk(cx, cz);
             }
         }
     }
     SDL_SetRelativeMouseMode(SDL_TRUE);
+    if(timingsFile)
+        timingsOpen(timingsFile);
     Uint32 lastTime = SDL_GetTicks();
+    uint64_t lastFrameNs = profilerNowNs();
+    float lastDt = 0.0f;
+    bool firstFrame = true;
+    float swapMs = 0.0f;   // last frame's buffer swap, including any vsync wait
+    long frameCount = 0;
     bool running = true;
     SDL_Event ev;
-    Mat4 projWorld = perspectiveMatrix(45.0f*(3.14159f/180.0f),
-                                       (float)SCREEN_WIDTH/(float)SCREEN_HEIGHT,
-                                       0.1f, 100.0f);
     while(running) {
+        PROFILE_ZONE("frame");
+        uint64_t frameNs = profilerNowNs();
+        float frameMs = (frameNs - lastFrameNs) / 1.0e6f;
+        if(!firstFrame)
+            timingsWriteFrame(lastDt * 1000.0f, frameMs, gpuTimerMs(GPU_PASS_WORLD),
+                              gpuPassSamples(GPU_PASS_WORLD));
+        firstFrame = false;
+        statsBeginFrame(frameMs);
+        lastFrameNs = frameNs;
+        if(adaptiveDistance) {
+            // Time spent waiting for vsync is idle, or every frame would
+            // look exactly on target.
+            float busyMs = std::max(frameMs - swapMs, gpuTimerMs(GPU_PASS_WORLD));
+            if(viewDistanceUpdate(viewDistance, busyMs)) {
+                renderDistance = viewDistance.distance;
+                sectionOrderStale = true;
+            }
+        }
+        g_perf.renderDistance = renderDistance;
+        if(maxFrames >= 0 && frameCount >= maxFrames)
+            break;
+        frameCount++;
         Uint32 now = SDL_GetTicks();
         float dt = (now - lastTime) * 0.001f;
         lastTime = now;
+        if(headless)
+            dt = 1.0f / 60.0f;
+        if(!inputBeginFrame(dt))
+            break;
+        lastDt = dt;
         tickAccumulator += dt;
         while(tickAccumulator >= TICK_INTERVAL) {
             tickCount++;
             tickAccumulator -= TICK_INTERVAL;
             if(tickCount % 2 == 0) {
+                uint64_t waterStart = profilerNowNs();
                 updateWaterFlow(camera, TICK_INTERVAL);
+                g_perf.waterMs += (profilerNowNs() - waterStart) / 1.0e6f;
             }
         }
-        while(SDL_PollEvent(&ev)) {
+        while(inputPollEvent(&ev)) {
             if(ev.type == SDL_QUIT) running = false;
             else if(ev.type == SDL_KEYDOWN) {
                 if(ev.key.keysym.sym == SDLK_ESCAPE) {
@@ -829,6 +1210,21 @@ int main(int /*argc*/, char* /*argv*/[]) {
                     if(inventory.isOpen()) inventory.toggle();
                     SDL_SetRelativeMouseMode(paused ? SDL_FALSE : SDL_TRUE);
                 }
+                else if(ev.key.keysym.sym == SDLK_F3) {
+                    showHud = !showHud;
+                }
+                else if(ev.key.keysym.sym == SDLK_F9) {
+                    if(profilerEnabled()) {
+                        profilerSetEnabled(false);
+                        profilerWriteChromeTrace(traceFile);
+                    } else {
+                        // Capture is off and the occlusion worker idle
+                        // between frames, as profilerClear() requires.
+                        profilerClear();
+                        profilerSetEnabled(true);
+                        std::cout << "[Profiler] Capture started\n";
+                    }
+                }
                 else if(ev.key.keysym.sym == SDLK_f) {
                     isFlying = !isFlying;
                     verticalVelocity = 0.0f;
@@ -866,13 +1262,12 @@ int main(int /*argc*/, char* /*argv*/[]) {
                 bool hit = raycastBlock(eyePos, viewDir, 5.0f, bx, by, bz);
                 if(hit) {
                     if(ev.button.button == SDL_BUTTON_LEFT) {
-                        auto it = extraBlocks.find({bx,by,bz});
+                        auto it = extraBlocks.find(packBlockKey(bx, by, bz));
                         if(it != extraBlocks.end())
-                            extraBlocks.erase(it);
+                            removeExtraBlock(bx, by, bz);
                         else
-                            extraBlocks[{bx,by,bz}] = (BlockType)(-1);
-                        int cx, cz; getChunkCoords(bx, bz, cx, cz);
-                        rebuildChunk(cx, cz);
+                            setExtraBlock(bx, by, bz, (BlockType)(-1));
+                        remeshMarkBlock(bx, by, bz);
                     }
                     else if(ev.button.button == SDL_BUTTON_RIGHT) {
                         float stepBack = 0.05f, traveled = 0.0f;
@@ -890,11 +1285,10 @@ int main(int /*argc*/, char* /*argv*/[]) {
                                 int pbz = (int)std::floor(placePos.z);
                                 if(!isSolidBlock(pbx, pby, pbz)) {
                                     int blockToPlace = inventory.getSelectedBlock();
-                                    extraBlocks[{pbx, pby, pbz}] = (BlockType)blockToPlace;
+                                    setExtraBlock(pbx, pby, pbz, (BlockType)blockToPlace);
                                     if(blockToPlace == BLOCK_WATER)
-                                        waterLevels[{pbx, pby, pbz}] = 8;
-                                    int cpx, cpz; getChunkCoords(pbx, pbz, cpx, cpz);
-                                    rebuildChunk(cpx, cpz);
+                                        setWaterLevel(pbx, pby, pbz, 8);
+                                    remeshMarkBlock(pbx, pby, pbz);
                                 }
                                 break;
                             }
@@ -905,53 +1299,45 @@ int main(int /*argc*/, char* /*argv*/[]) {
             }
         }
         if(paused) {
+            uint64_t renderStart = profilerNowNs();
+            gpuTimerBegin(GPU_PASS_WORLD);
             glClearColor(0.53f, 0.81f, 0.92f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glUseProgram(worldShader);
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, texID);
-            GLint tLoc = glGetUniformLocation(worldShader, "ourTexture");
-            glUniform1i(tLoc, 0);
-            Vec3 eyePos = camera.position; eyePos.y += 1.6f;
-            Vec3 viewDir = { cos(camera.yaw)*cos(camera.pitch),
-                             sin(camera.pitch),
-                             sin(camera.yaw)*cos(camera.pitch) };
-            Vec3 camTgt = add(eyePos, viewDir);
-            Mat4 view = lookAtMatrix(eyePos, camTgt, {0,1,0});
-            Mat4 proj = perspectiveMatrix(45.0f*(3.14159f/180.0f),
-                                          (float)SCREEN_WIDTH/(float)SCREEN_HEIGHT,
-                                          0.1f, 100.0f);
-            Mat4 pv = multiplyMatrix(proj, view);
+            Mat4 pv = worldViewProjection(camera);
             int pcx = (int)std::floor(camera.position.x/(float)chunkSize);
             int pcz = (int)std::floor(camera.position.z/(float)chunkSize);
-            for(auto &pair : chunks) {
-                int cX = pair.first.first, cZ = pair.first.second;
-                if(std::abs(cX-pcx) > renderDistance || std::abs(cZ-pcz) > renderDistance)
-                    continue;
-                Chunk &ch = pair.second;
-                Mat4 mvp = multiplyMatrix(pv, identityMatrix());
-                GLint mvpLoc = glGetUniformLocation(worldShader, "MVP");
-                glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, mvp.m);
-                glBindVertexArray(ch.VAO);
-                glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(ch.vertices.size()/5));
-            }
+            drawWorld(pv, camera, pcx, pcz);
+            gpuTimerEnd(GPU_PASS_WORLD);
+            gpuTimerBegin(GPU_PASS_UI);
+            uiBegin(SCREEN_WIDTH, SCREEN_HEIGHT);
             int clicked = drawPauseMenu(SCREEN_WIDTH, SCREEN_HEIGHT);
+            if(showHud)
+                hudDraw(SCREEN_WIDTH, SCREEN_HEIGHT, hudWorldInfo());
+            uiFlush();
+            gpuTimerEnd(GPU_PASS_UI);
             if(clicked == 1) {
                 paused = false;
                 SDL_SetRelativeMouseMode(SDL_TRUE);
             }
-            else if(clicked == 2) {
-                saveWorld("saved_world.txt", loadedSeed,
-                          camera.position.x, camera.position.y, camera.position.z);
+            else if(clicked == 2)
                 running = false;
+            gpuTimersEndFrame();
+            {
+                PROFILE_ZONE("SDL_GL_SwapWindow");
+                uint64_t swapStart = profilerNowNs();
+                if(headless) headlessPresent();
+                else SDL_GL_SwapWindow(window);
+                swapMs = (profilerNowNs() - swapStart) / 1.0e6f;
             }
-            SDL_GL_SwapWindow(window);
+            g_perf.renderMs += (profilerNowNs() - renderStart) / 1.0e6f;
             continue;
         }
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         if(!inventory.isOpen()){
-            const Uint8* keys = SDL_GetKeyboardState(nullptr);
+            const Uint8* keys = inputKeyboardState();
             float speed = 10.0f * dt;
             Vec3 forward = { cos(camera.yaw), 0, sin(camera.yaw) };
             forward = normalize(forward);
@@ -1002,51 +1388,50 @@ int main(int /*argc*/, char* /*argv*/[]) {
         inventory.update(dt, camera);
         int pcx = (int)std::floor(camera.position.x/(float)chunkSize);
         int pcz = (int)std::floor(camera.position.z/(float)chunkSize);
-        for(int cx = pcx - renderDistance; cx <= pcx + renderDistance; cx++){
-            for(int cz = pcz - renderDistance; cz <= pcz + renderDistance; cz++){
-                std::pair<int,int> key = {cx, cz};
-                if(chunks.find(key) == chunks.end())
-                    chunks[key] = generateChunk(cx, cz);
-            }
+        {
+            PROFILE_ZONE("load chunks");
+            loadQueueUpdate(camera.position.x, camera.position.z,
+                            frustumFromMatrix(worldViewProjection(camera)),
+                            renderDistance, isChunkLoaded);
+            int cx, cz;
+            for(int n = 0; n < LOAD_CHUNKS_PER_FRAME && loadQueuePop(cx, cz); n++)
+                generateChunk(cx, cz);
+            g_perf.loadPending = (int)loadQueueSize();
         }
+        if(pcx != coldCheckX || pcz != coldCheckZ) {
+            packColdChunks(pcx, pcz);
+            coldCheckX = pcx;
+            coldCheckZ = pcz;
+        }
+        if(occlusionEnabled)
+            submitOcclusion(worldViewProjection(camera), camera, pcx, pcz);
+        remeshDrain(camera.position.x, camera.position.y, camera.position.z,
+                    REMESH_BUDGET_MS, rebuildSection);
+        g_perf.remeshPending = (int)remeshPending();
+        uploadFlush(sectionUploadTarget, lodUploadTarget);
+        g_perf.uploadPending = (int)uploadPending();
+        updateLodChunks(pcx, pcz);
+        uint64_t renderStart = profilerNowNs();
+        gpuTimerBegin(GPU_PASS_WORLD);
         glClearColor(0.53f, 0.81f, 0.92f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glUseProgram(worldShader);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, texID);
-        GLint uniTex = glGetUniformLocation(worldShader, "ourTexture");
-        glUniform1i(uniTex, 0);
-        // Set directional light and view position for realistic lighting.
-        Vec3 sunDir = normalize({0.3f, 1.0f, 0.3f});
-        glUniform3f(glGetUniformLocation(worldShader, "sunDirection"), sunDir.x, sunDir.y, sunDir.z);
-        glUniform3f(glGetUniformLocation(worldShader, "viewPos"), camera.position.x, camera.position.y, camera.position.z);
-        
-        Vec3 eyePos = camera.position; eyePos.y += 1.6f;
-        Vec3 viewDir = { cos(camera.yaw)*cos(camera.pitch),
-                         sin(camera.pitch),
-                         sin(camera.yaw)*cos(camera.pitch) };
-        Vec3 camTgt = add(eyePos, viewDir);
-        Mat4 view = lookAtMatrix(eyePos, camTgt, {0,1,0});
-        Mat4 projWorld = perspectiveMatrix(45.0f*(3.14159f/180.0f),
-                                           (float)SCREEN_WIDTH/(float)SCREEN_HEIGHT,
-                                           0.1f, 100.0f);
-        Mat4 pv = multiplyMatrix(projWorld, view);
-        for(auto &pair: chunks){
-            int cX = pair.first.first, cZ = pair.first.second;
-            if(std::abs(cX-pcx) > renderDistance || std::abs(cZ-pcz) > renderDistance)
-                continue;
-            Chunk &ch = pair.second;
-            Mat4 mvp = multiplyMatrix(pv, identityMatrix());
-            GLint mvpLoc = glGetUniformLocation(worldShader, "MVP");
-            glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, mvp.m);
-            glBindVertexArray(ch.VAO);
-            glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(ch.vertices.size()/5));
-        }
-        glUseProgram(uiShader);
+        Mat4 projWorld = worldProjection();
+        Mat4 pv = worldViewProjection(camera);
+        drawWorld(pv, camera, pcx, pcz);
+        gpuTimerEnd(GPU_PASS_WORLD);
+        gpuTimerBegin(GPU_PASS_UI);
+        uiBegin(SCREEN_WIDTH, SCREEN_HEIGHT);
         drawFlyIndicator(isFlying, SCREEN_WIDTH, SCREEN_HEIGHT);
+        if(showHud)
+            hudDraw(SCREEN_WIDTH, SCREEN_HEIGHT, hudWorldInfo());
         inventory.render();
+        uiFlush();
+        gpuTimerEnd(GPU_PASS_UI);
         // Render held item: if a block is selected, render it as a 3D cube;
         // otherwise, render the hand as a rectangle.
+        gpuTimerBegin(GPU_PASS_HELD_ITEM);
         if(inventory.getSelectedBlock() != BLOCK_NONE) {
             glDisable(GL_DEPTH_TEST);
             renderHeldBlock3D(projWorld, inventory.getSelectedBlock());
@@ -1056,17 +1441,39 @@ int main(int /*argc*/, char* /*argv*/[]) {
             renderHandRect(projWorld);
             glEnable(GL_DEPTH_TEST);
         }
-        SDL_GL_SwapWindow(window);
+        gpuTimerEnd(GPU_PASS_HELD_ITEM);
+        gpuTimersEndFrame();
+        {
+            PROFILE_ZONE("SDL_GL_SwapWindow");
+            uint64_t swapStart = profilerNowNs();
+            if(headless) headlessPresent();
+            else SDL_GL_SwapWindow(window);
+            swapMs = (profilerNowNs() - swapStart) / 1.0e6f;
+        }
+        g_perf.renderMs += (profilerNowNs() - renderStart) / 1.0e6f;
+    }
+    if(!firstFrame)
+        timingsWriteFrame(lastDt * 1000.0f, (profilerNowNs() - lastFrameNs) / 1.0e6f,
+                          gpuTimerMs(GPU_PASS_WORLD), gpuPassSamples(GPU_PASS_WORLD));
+    timingsClose();
+    inputClose();
+    if(headless && screenshotFile)
+        headlessWritePPM(screenshotFile);
+    if(!freshWorld)
+        saveWorld("saved_world.txt", loadedSeed,
+                  camera.position.x, camera.position.y, camera.position.z);
+    if(profilerEnabled()) {
+        profilerSetEnabled(false);
+        profilerWriteChromeTrace(traceFile);
     }
-    saveWorld("saved_world.txt", loadedSeed,
-              camera.position.x, camera.position.y, camera.position.z);
     glDeleteProgram(worldShader);
-    glDeleteProgram(uiShader);
-    glDeleteVertexArrays(1, &uiVAO);
-    glDeleteBuffers(1, &uiVBO);
-    SDL_GL_DeleteContext(glContext);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    glDeleteProgram(worldOpaqueShader);
+    gpuTimersShutdown();
+    occlusionStopWorker();
+    uploadShutdown();
+    fontShutdown();
+    uiShutdown();
+    shutdownVideo(window, glContext);
     return 0;
 }
 
@@ -83,3 +83,29 @@ Mat4 lookAtMatrix(const Vec3& eye, const Vec3& center, const Vec3& up) {
     mat.m[14] = dot(f, eye);
     return mat;
 }
+
+Frustum frustumFromMatrix(const Mat4& pv) {
+    // Gribb/Hartmann: each plane is the last row of the matrix plus or
+    // minus one of the others (left/right, bottom/top, near/far).
+    Frustum f;
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        for (int col = 0; col < 4; col++)
+            f.planes[i][col] = pv.m[col*4 + 3] + sign * pv.m[col*4 + row];
+    }
+    return f;
+}
+
+bool frustumIntersectsBox(const Frustum& f, const Vec3& boxMin, const Vec3& boxMax) {
+    for (int i = 0; i < 6; i++) {
+        const float* p = f.planes[i];
+        // The box corner furthest along the plane normal.
+        float x = p[0] >= 0.0f ? boxMax.x : boxMin.x;
+        float y = p[1] >= 0.0f ? boxMax.y : boxMin.y;
+        float z = p[2] >= 0.0f ? boxMax.z : boxMin.z;
+        if (p[0]*x + p[1]*y + p[2]*z + p[3] < 0.0f)
+            return false;
+    }
+    return true;
+}
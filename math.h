@@ -23,4 +23,15 @@ Mat4 multiplyMatrix(const Mat4& a, const Mat4& b);
 Mat4 perspectiveMatrix(float fovRadians, float aspect, float near, float far);
 Mat4 lookAtMatrix(const Vec3& eye, const Vec3& center, const Vec3& up);
 
+// View frustum as six planes (a, b, c, d); a point is inside a plane when
+// a*x + b*y + c*z + d >= 0.
+struct Frustum {
+    float planes[6][4];
+};
+
+// Planes of a projection * view matrix.
+Frustum frustumFromMatrix(const Mat4& pv);
+// Conservative: false only if the box is entirely outside one plane.
+bool frustumIntersectsBox(const Frustum& f, const Vec3& boxMin, const Vec3& boxMax);
+
 #endif // MATH_H
@@ -0,0 +1,8 @@
+#include "mesharena.h"
+
+MeshArena &threadMeshArena()
+{
+    static thread_local MeshArena arena;
+    arena.clear();
+    return arena;
+}
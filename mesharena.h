@@ -0,0 +1,38 @@
+#ifndef MESHARENA_H
+#define MESHARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// Scratch space for mesh building, reused from one build to the next so
+// steady-state meshing doesn't touch the allocator. Writers ask for room
+// up front with append() and fill it through the returned pointer.
+struct MeshArena {
+    std::vector<float> storage;   // only ever grows
+    size_t used;
+    unsigned long long growths;   // times storage had to be reallocated
+
+    MeshArena() : used(0), growths(0) {}
+
+    void clear() { used = 0; }
+
+    // Returns room for `floats` more floats at the end, counted as used.
+    float* append(size_t floats) {
+        if(used + floats > storage.size()) {
+            size_t grown = storage.size() * 2;
+            storage.resize(grown > used + floats ? grown : used + floats);
+            growths++;
+        }
+        float* out = storage.data() + used;
+        used += floats;
+        return out;
+    }
+
+    const float* data() const { return storage.data(); }
+    size_t size() const { return used; }
+};
+
+// The calling thread's arena, cleared and ready for a new mesh.
+MeshArena &threadMeshArena();
+
+#endif // MESHARENA_H
@@ -0,0 +1,292 @@
+#include "mesher.h"
+#include "blocks.h"
+#include "cube.h"
+#include "profiler.h"
+#include "world.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// The mesher resolves a section into dense arrays once, then finds visible
+// faces with bit operations instead of asking isOccludingBlock() (a hash
+// lookup and, for terrain, a noise evaluation) for every face:
+//
+//  - Occupancy: one 64-bit word per (y, z) row, bit x set if the block at
+//    local x occludes. Rows cover the section plus a one-block border taken
+//    from the neighbouring chunks (local x/z = -1..16 map to bits/rows
+//    0..17) and one layer above and below from the sections there.
+//  - Presence: same layout, bit set for every block of this section that
+//    gets drawn.
+//  - Water: same layout, bit set for water cells.
+//
+// A face is visible where a present block's neighbour in that direction
+// isn't occluding, e.g. +x faces of a row are present & ~(occ >> 1).
+// Water doesn't occlude, but a water face is also hidden by water on the
+// other side, so a body of water only gets its outer surface.
+//
+// Sections without edits are natural terrain, which is resolved from the
+// column heights and biomes alone: above the terrain they are empty and
+// skipped outright, and deep down they are usually one block type
+// throughout.
+
+static const int CHUNK = 16;
+static const int PADDED = CHUNK + 2;
+// Presence bits of a full row of the section (padded x = 1..16).
+static const uint64_t ROW_MASK = ((1ull << CHUNK) - 1) << 1;
+
+namespace {
+
+struct SectionGrid {
+    int y0;                              // world y of the section's bottom layer
+    uint64_t occ[PADDED][PADDED];        // [layer][padded z] -> bits padded x;
+    uint64_t present[PADDED][PADDED];    //   layer l holds world y = y0 + l - 1
+    uint64_t water[PADDED][PADDED];
+    int8_t types[CHUNK][CHUNK][CHUNK];   // [y][z][x] for this section
+    bool edited[3][3][3];                // [y][z][x]: neighbouring section has edits
+};
+
+}
+
+// Which of the three neighbouring sections along an axis a padded
+// coordinate falls into.
+static inline int sectionSide(int p) {
+    return p == 0 ? 0 : (p == PADDED - 1 ? 2 : 1);
+}
+
+// Block type and occlusion of one padded cell: a cell occludes when the
+// block there does, so natural water and the air above an ocean floor
+// don't. The maps are only consulted in sections that have edits.
+static void resolveCell(const ChunkColumns &cols, const SectionGrid &g,
+                        int px, int layer, int pz, BlockType &type, bool &occ) {
+    int y = g.y0 + layer - 1;
+    int height = cols.heights[pz][px];
+    if(g.edited[sectionSide(layer)][sectionSide(pz)][sectionSide(px)]) {
+        uint64_t key = packBlockKey(cols.cx * CHUNK + px - 1, y, cols.cz * CHUNK + pz - 1);
+        bool water = waterLevels.find(key) != waterLevels.end();
+        auto it = extraBlocks.find(key);
+        if(it != extraBlocks.end()) {
+            type = (int)it->second < 0 ? BLOCK_NONE : it->second;
+            occ = type != BLOCK_NONE && blockInfo(type).occludes;
+            if(water) type = BLOCK_WATER;
+            return;
+        }
+        if(water) {
+            type = BLOCK_WATER;
+            occ = blockInfo(BLOCK_WATER).occludes;
+            return;
+        }
+    }
+    type = naturalBlockAt(cols.biomes[pz][px], height, y);
+    occ = type != BLOCK_NONE && blockInfo(type).occludes;
+}
+
+// Natural columns are bands of one block type each (stone, dirt,
+// grass/sand; or water, sand, bedrock), so an unedited section is uniform
+// when every column has the same block at its bottom and top.
+static bool uniformNatural(const ChunkColumns &cols, int y0, BlockType &type) {
+    type = naturalBlockAt(cols.biomes[1][1], cols.heights[1][1], y0);
+    for(int pz = 1; pz <= CHUNK; pz++) {
+        for(int px = 1; px <= CHUNK; px++) {
+            Biome biome = cols.biomes[pz][px];
+            int height = cols.heights[pz][px];
+            if(naturalBlockAt(biome, height, y0) != type ||
+               naturalBlockAt(biome, height, y0 + CHUNK - 1) != type)
+                return false;
+        }
+    }
+    return true;
+}
+
+void sampleChunkColumns(int cx, int cz, ChunkColumns &cols)
+{
+    cols.cx = cx;
+    cols.cz = cz;
+    cols.naturalTop = -1;
+    int baseX = cx * CHUNK - 1, baseZ = cz * CHUNK - 1;
+    for(int pz = 0; pz < PADDED; pz++) {
+        for(int px = 0; px < PADDED; px++) {
+            TerrainColumn col = sampleTerrainColumn(baseX + px, baseZ + pz);
+            cols.heights[pz][px] = col.height;
+            cols.biomes[pz][px] = col.biome;
+            bool inside = px >= 1 && px <= CHUNK && pz >= 1 && pz <= CHUNK;
+            int top = naturalTopY(col.biome, col.height);
+            if(inside && top > cols.naturalTop)
+                cols.naturalTop = top;
+        }
+    }
+}
+
+int chunkSectionCount(const ChunkColumns &cols)
+{
+    return std::max(getSectionY(cols.naturalTop), topEditedSection(cols.cx, cols.cz)) + 1;
+}
+
+LayeredMesh &threadLayeredMesh()
+{
+    static thread_local LayeredMesh mesh;
+    mesh.clear();
+    return mesh;
+}
+
+static float* emitFaces(float* out, const SectionGrid &g, int cx, int cz,
+                        int layer, int pz, uint64_t mask, CubeFace face) {
+    float y = (float)(g.y0 + layer - 1);
+    float wz = (float)(cz * CHUNK + pz - 1);
+    while(mask) {
+        int px = __builtin_ctzll(mask);
+        mask &= mask - 1;
+        BlockType t = (BlockType)g.types[layer - 1][pz - 1][px - 1];
+        writeCubeFace(out, (float)(cx * CHUNK + px - 1), y, wz, t, face);
+        out += FACE_FLOATS;
+    }
+    return out;
+}
+
+// Like emitFaces(), but appends each face to the layer of its block.
+static void emitLayeredFaces(LayeredMesh &out, const SectionGrid &g, int cx, int cz,
+                             int layer, int pz, uint64_t mask, CubeFace face) {
+    float y = (float)(g.y0 + layer - 1);
+    float wz = (float)(cz * CHUNK + pz - 1);
+    while(mask) {
+        int px = __builtin_ctzll(mask);
+        mask &= mask - 1;
+        BlockType t = (BlockType)g.types[layer - 1][pz - 1][px - 1];
+        MeshArena &dst = out.layers[blockInfo(t).layer];
+        writeCubeFace(dst.append(FACE_FLOATS), (float)(cx * CHUNK + px - 1), y, wz, t, face);
+    }
+}
+
+SectionFill buildSectionMesh(const ChunkColumns &cols, int sy, LayeredMesh &out)
+{
+    SectionGrid g;
+    g.y0 = sy * CHUNK;
+    for(int dy = 0; dy < 3; dy++)
+        for(int dz = 0; dz < 3; dz++)
+            for(int dx = 0; dx < 3; dx++)
+                g.edited[dy][dz][dx] = sectionEditCount(cols.cx + dx - 1, sy + dy - 1, cols.cz + dz - 1) > 0;
+    bool ownEdited = g.edited[1][1][1];
+    if(!ownEdited && g.y0 > cols.naturalTop)
+        return SECTION_EMPTY;
+
+    PROFILE_ZONE("addCube batch");
+    std::memset(g.occ, 0, sizeof(g.occ));
+    std::memset(g.present, 0, sizeof(g.present));
+    std::memset(g.water, 0, sizeof(g.water));
+
+    // This section's own blocks.
+    SectionFill fill = SECTION_MIXED;
+    unsigned layers = 0;   // bit per RenderLayer drawn
+    BlockType uniform;
+    if(!ownEdited && uniformNatural(cols, g.y0, uniform)) {
+        // Every cell holds the same natural block, so it is present, and
+        // occluding if that block is.
+        fill = SECTION_UNIFORM;
+        layers = 1u << blockInfo(uniform).layer;
+        std::memset(g.types, (int8_t)uniform, sizeof(g.types));
+        uint64_t occ = blockInfo(uniform).occludes ? ROW_MASK : 0;
+        uint64_t water = uniform == BLOCK_WATER ? ROW_MASK : 0;
+        for(int layer = 1; layer <= CHUNK; layer++) {
+            for(int pz = 1; pz <= CHUNK; pz++) {
+                g.present[layer][pz] = ROW_MASK;
+                g.occ[layer][pz] = occ;
+                g.water[layer][pz] = water;
+            }
+        }
+    }
+    else {
+        bool any = false;
+        for(int layer = 1; layer <= CHUNK; layer++) {
+            for(int pz = 1; pz <= CHUNK; pz++) {
+                for(int px = 1; px <= CHUNK; px++) {
+                    BlockType t;
+                    bool occ;
+                    resolveCell(cols, g, px, layer, pz, t, occ);
+                    g.types[layer - 1][pz - 1][px - 1] = (int8_t)t;
+                    if(t != BLOCK_NONE) {
+                        g.present[layer][pz] |= 1ull << px;
+                        layers |= 1u << blockInfo(t).layer;
+                        any = true;
+                    }
+                    if(occ) g.occ[layer][pz] |= 1ull << px;
+                    if(t == BLOCK_WATER) g.water[layer][pz] |= 1ull << px;
+                }
+            }
+        }
+        if(!any)
+            return SECTION_EMPTY;
+    }
+
+    // The border only matters where it touches a drawn block, so look it
+    // up only there.
+    for(int layer = 0; layer < PADDED; layer++) {
+        for(int pz = 0; pz < PADDED; pz++) {
+            uint64_t near = g.present[layer][pz];
+            near = (near << 1) | (near >> 1);
+            if(pz > 0) near |= g.present[layer][pz - 1];
+            if(pz < PADDED - 1) near |= g.present[layer][pz + 1];
+            if(layer > 0) near |= g.present[layer - 1][pz];
+            if(layer < PADDED - 1) near |= g.present[layer + 1][pz];
+            bool ownRow = layer >= 1 && layer <= CHUNK && pz >= 1 && pz <= CHUNK;
+            if(ownRow) near &= ~ROW_MASK; // resolved above
+            while(near) {
+                int px = __builtin_ctzll(near);
+                near &= near - 1;
+                if(px >= PADDED) break;
+                BlockType t;
+                bool occ;
+                resolveCell(cols, g, px, layer, pz, t, occ);
+                if(occ) g.occ[layer][pz] |= 1ull << px;
+                if(t == BLOCK_WATER) g.water[layer][pz] |= 1ull << px;
+            }
+        }
+    }
+
+    // Masks are indexed by CubeFace. When every block is in the same layer
+    // (most sections), each row's faces are counted first so they can be
+    // written straight into that layer's arena.
+    MeshArena *single = (layers & (layers - 1)) ? nullptr
+                                                : &out.layers[__builtin_ctz(layers)];
+    for(int layer = 1; layer <= CHUNK; layer++) {
+        for(int pz = 1; pz <= CHUNK; pz++) {
+            uint64_t present = g.present[layer][pz];
+            if(!present) continue;
+            uint64_t occ = g.occ[layer][pz];
+            uint64_t water = g.water[layer][pz];
+            // What hides the face of each block in a direction, given the
+            // rows next to it.
+            auto hidden = [water](uint64_t nearOcc, uint64_t nearWater) {
+                return nearOcc | (nearWater & water);
+            };
+            uint64_t masks[6] = {
+                present & ~hidden(g.occ[layer][pz + 1], g.water[layer][pz + 1]),
+                present & ~hidden(g.occ[layer][pz - 1], g.water[layer][pz - 1]),
+                present & ~hidden(occ << 1, water << 1),
+                present & ~hidden(occ >> 1, water >> 1),
+                present & ~hidden(g.occ[layer + 1][pz], g.water[layer + 1][pz]),
+                present & ~hidden(g.occ[layer - 1][pz], g.water[layer - 1][pz]),
+            };
+            if(!single) {
+                for(int f = 0; f < 6; f++)
+                    emitLayeredFaces(out, g, cols.cx, cols.cz, layer, pz, masks[f], (CubeFace)f);
+                continue;
+            }
+            int faces = 0;
+            for(uint64_t m : masks)
+                faces += __builtin_popcountll(m);
+            if(!faces) continue;
+            float* dst = single->append((size_t)faces * FACE_FLOATS);
+            for(int f = 0; f < 6; f++)
+                dst = emitFaces(dst, g, cols.cx, cols.cz, layer, pz, masks[f], (CubeFace)f);
+        }
+    }
+    return fill;
+}
+
+void buildChunkMesh(int cx, int cz, LayeredMesh &out)
+{
+    ChunkColumns cols;
+    sampleChunkColumns(cx, cz, cols);
+    int count = chunkSectionCount(cols);
+    for(int sy = 0; sy < count; sy++)
+        buildSectionMesh(cols, sy, out);
+}
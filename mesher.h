@@ -0,0 +1,75 @@
+#ifndef MESHER_H
+#define MESHER_H
+
+#include "blocks.h"
+#include "mesharena.h"
+#include "terrain.h"
+
+// Chunks are meshed in 16x16x16 sections (section sy covers world y
+// 16*sy .. 16*sy+15), so an edit only remeshes the section it touches and
+// the empty sky above the terrain costs nothing.
+//
+// Meshes are triangles with 5 floats per vertex (position and UV, as
+// produced by addCube), one list per RenderLayer so each draw pass only
+// touches the faces it draws. The mesher reads the terrain and the
+// extraBlocks/waterLevels maps but never modifies them, so several
+// sections can be meshed in parallel as long as nothing writes the maps.
+
+// What a section holds.
+enum SectionFill {
+    SECTION_EMPTY,   // all air: no mesh
+    SECTION_UNIFORM, // unedited, and every block is the same natural block
+    SECTION_MIXED
+};
+
+// Terrain height and biome of every column of a chunk plus a one-block
+// border, sampled once and shared by all of the chunk's sections.
+struct ChunkColumns {
+    int cx, cz;
+    int heights[18][18];   // [z][x], local -1..16 -> 0..17
+    Biome biomes[18][18];
+    int naturalTop;        // highest natural block inside the chunk
+};
+
+// A mesh split by render layer, indexed by RenderLayer.
+struct LayeredMesh {
+    MeshArena layers[RENDER_LAYER_COUNT];
+
+    void clear() {
+        for(MeshArena &layer : layers)
+            layer.clear();
+    }
+
+    // Floats in all layers together.
+    size_t size() const {
+        size_t floats = 0;
+        for(const MeshArena &layer : layers)
+            floats += layer.size();
+        return floats;
+    }
+
+    unsigned long long growths() const {
+        unsigned long long n = 0;
+        for(const MeshArena &layer : layers)
+            n += layer.growths;
+        return n;
+    }
+};
+
+// The calling thread's layered mesh, cleared and ready for a new mesh.
+LayeredMesh &threadLayeredMesh();
+
+void sampleChunkColumns(int cx, int cz, ChunkColumns &cols);
+
+// Number of sections, from sy = 0, that can hold blocks: enough to cover
+// both the natural terrain and the highest edited section.
+int chunkSectionCount(const ChunkColumns &cols);
+
+// Appends the mesh of section sy of the chunk to out, each face to the
+// layer of its block, and returns what the section holds.
+SectionFill buildSectionMesh(const ChunkColumns &cols, int sy, LayeredMesh &out);
+
+// Appends every section of chunk (cx, cz), bottom to top.
+void buildChunkMesh(int cx, int cz, LayeredMesh &out);
+
+#endif // MESHER_H
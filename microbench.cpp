@@ -0,0 +1,340 @@
+// Microbenchmarks for the hot world kernels. Build and run with `make bench`.
+//
+// Each benchmark is calibrated so one sample takes about 20 ms, warmed up
+// with one untimed sample, then timed over several samples. Reported
+// numbers are per call: median, min and the median absolute deviation,
+// which is less sensitive than the mean to the occasional preempted sample.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "coords.h"
+#include "cube.h"
+#include "flatmap.h"
+#include "math.h"
+#include "noise.h"
+#include "terrain.h"
+#include "world.h"
+
+static const int SAMPLES = 15;
+static const double TARGET_SAMPLE_SECONDS = 0.02;
+
+// Results are folded into this so the compiler can't drop the work.
+static volatile double g_sink = 0.0;
+
+static const char *g_filter = nullptr;
+
+static double nowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Times fn(iterations) and prints per-iteration statistics. fn must run
+// its body `iterations` times.
+template <typename Fn>
+static void bench(const std::string &name, Fn fn) {
+    if(g_filter && name.find(g_filter) == std::string::npos)
+        return;
+
+    // Calibrate: grow the iteration count until one sample is long enough
+    // that timer resolution doesn't matter.
+    long long iters = 1;
+    for(;;) {
+        double t0 = nowSeconds();
+        fn(iters);
+        double dt = nowSeconds() - t0;
+        if(dt >= TARGET_SAMPLE_SECONDS || iters >= (1LL << 40))
+            break;
+        double scale = dt > 0 ? TARGET_SAMPLE_SECONDS / dt : 100.0;
+        if(scale > 100.0) scale = 100.0;
+        iters = (long long)(iters * scale * 1.2) + 1;
+    }
+
+    fn(iters); // warmup
+
+    std::vector<double> ns;
+    for(int s = 0; s < SAMPLES; s++) {
+        double t0 = nowSeconds();
+        fn(iters);
+        ns.push_back((nowSeconds() - t0) * 1e9 / iters);
+    }
+    std::sort(ns.begin(), ns.end());
+    double median = ns[ns.size() / 2];
+    std::vector<double> dev;
+    for(double v : ns)
+        dev.push_back(std::fabs(v - median));
+    std::sort(dev.begin(), dev.end());
+    double mad = dev[dev.size() / 2];
+
+    std::printf("%-40s %10.2f ns  (min %9.2f, mad %6.2f, %5.1f%%)  %12lld iters\n",
+                name.c_str(), median, ns.front(), mad,
+                median > 0 ? 100.0 * mad / median : 0.0, iters);
+}
+
+// Deterministic coordinates spread over a few thousand blocks so the
+// benchmarks don't hit the same cache lines every call.
+struct CoordStream {
+    unsigned int state;
+    CoordStream() : state(0x12345678u) {}
+    unsigned int nextRaw() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    // Uniform in [-range/2, range/2).
+    int next(int range) {
+        return (int)(nextRaw() % (unsigned int)range) - range / 2;
+    }
+};
+
+static const struct { BlockType type; const char *name; } BENCH_BLOCKS[] = {
+    { BLOCK_GRASS, "grass" },
+    { BLOCK_DIRT, "dirt" },
+    { BLOCK_STONE, "stone" },
+    { BLOCK_SAND, "sand" },
+    { BLOCK_TREE_LOG, "tree log" },
+    { BLOCK_LEAVES, "leaves" },
+    { BLOCK_WATER, "water" },
+    { BLOCK_GLASS, "glass" },
+    { BLOCK_WOOL_ORANGE, "wool (orange)" },
+};
+
+int main(int argc, char *argv[]) {
+    if(argc > 1)
+        g_filter = argv[1];
+
+    setNoiseSeed(12345);
+    clearWorldEdits();
+
+    std::printf("%-40s %13s\n", "benchmark", "per call");
+
+    // --- Noise ---
+    bench("perlinNoise", [](long long n) {
+        float acc = 0.0f, x = 0.37f;
+        for(long long i = 0; i < n; i++) {
+            acc += perlinNoise(x, x * 0.7f);
+            x += 0.013f;
+        }
+        g_sink = g_sink + acc;
+    });
+    const int OCTAVES[] = { 1, 4, 6, 8 };
+    for(int octaves : OCTAVES) {
+        bench("fbmNoise octaves=" + std::to_string(octaves), [octaves](long long n) {
+            float acc = 0.0f, x = 0.37f;
+            for(long long i = 0; i < n; i++) {
+                acc += fbmNoise(x, x * 0.7f, octaves, 2.0f, 0.5f);
+                x += 0.013f;
+            }
+            g_sink = g_sink + acc;
+        });
+    }
+
+    // --- Terrain ---
+    bench("getBiome", [](long long n) {
+        CoordStream cs;
+        int acc = 0;
+        for(long long i = 0; i < n; i++)
+            acc += (int)getBiome(cs.next(8192), cs.next(8192));
+        g_sink = g_sink + acc;
+    });
+    bench("getTerrainHeightAt", [](long long n) {
+        CoordStream cs;
+        int acc = 0;
+        for(long long i = 0; i < n; i++)
+            acc += getTerrainHeightAt(cs.next(8192), cs.next(8192));
+        g_sink = g_sink + acc;
+    });
+
+    // isSolidBlock: a "hit" finds the block in extraBlocks; a "miss" falls
+    // through both maps to the terrain height.
+    std::vector<std::tuple<int,int,int>> placed;
+    {
+        CoordStream cs;
+        for(int i = 0; i < 4096; i++) {
+            std::tuple<int,int,int> key(cs.next(512), 30 + cs.next(16), cs.next(512));
+            setExtraBlock(std::get<0>(key), std::get<1>(key), std::get<2>(key), BLOCK_STONE);
+            placed.push_back(key);
+        }
+    }
+    bench("isSolidBlock hit (extraBlocks)", [&placed](long long n) {
+        int acc = 0;
+        size_t idx = 0;
+        for(long long i = 0; i < n; i++) {
+            const auto &k = placed[idx];
+            acc += isSolidBlock(std::get<0>(k), std::get<1>(k), std::get<2>(k));
+            if(++idx == placed.size()) idx = 0;
+        }
+        g_sink = g_sink + acc;
+    });
+    bench("isSolidBlock miss (terrain)", [](long long n) {
+        CoordStream cs;
+        int acc = 0;
+        for(long long i = 0; i < n; i++)
+            acc += isSolidBlock(cs.next(8192), 2 + cs.next(4), cs.next(8192));
+        g_sink = g_sink + acc;
+    });
+    clearWorldEdits();
+
+    // --- Meshing ---
+    // Unculled, so this measures vertex emission rather than neighbour
+    // lookups; the culled variant adds the six isSolidBlock calls.
+    for(const auto &b : BENCH_BLOCKS) {
+        BlockType type = b.type;
+        bench(std::string("addCube ") + b.name, [type](long long n) {
+            std::vector<float> verts;
+            verts.reserve(36 * 5);
+            size_t total = 0;
+            for(long long i = 0; i < n; i++) {
+                verts.clear();
+                addCube(verts, (float)(i & 15), 10.0f, 0.0f, type, false);
+                total += verts.size();
+            }
+            g_sink = g_sink + (double)total;
+        });
+    }
+    bench("addCube grass (culled)", [](long long n) {
+        std::vector<float> verts;
+        verts.reserve(36 * 5);
+        size_t total = 0;
+        for(long long i = 0; i < n; i++) {
+            verts.clear();
+            addCube(verts, (float)(i & 1023), 10.0f, 0.0f, BLOCK_GRASS, true);
+            total += verts.size();
+        }
+        g_sink = g_sink + (double)total;
+    });
+
+    // --- Hash maps ---
+    // The unordered_map variants are the maps the world used before
+    // FlatMap, kept as a baseline.
+    {
+        std::unordered_map<std::tuple<int,int,int>, BlockType, TupleHash> blocks;
+        FlatMap<BlockType> flatBlocks;
+        std::vector<std::tuple<int,int,int>> keys;
+        for(int x = 0; x < 64; x++)
+            for(int y = 0; y < 16; y++)
+                for(int z = 0; z < 64; z++) {
+                    std::tuple<int,int,int> key(x - 32, y, z - 32);
+                    blocks[key] = BLOCK_DIRT;
+                    flatBlocks[packBlockKey(x - 32, y, z - 32)] = BLOCK_DIRT;
+                    keys.push_back(key);
+                }
+        CoordStream cs;
+        for(size_t i = keys.size() - 1; i > 0; i--)
+            std::swap(keys[i], keys[cs.nextRaw() % (i + 1)]);
+
+        bench("TupleHash lookup hit (64K map)", [&](long long n) {
+            int acc = 0;
+            size_t idx = 0;
+            for(long long i = 0; i < n; i++) {
+                acc += (blocks.find(keys[idx]) != blocks.end());
+                if(++idx == keys.size()) idx = 0;
+            }
+            g_sink = g_sink + acc;
+        });
+        bench("TupleHash lookup miss (64K map)", [&](long long n) {
+            int acc = 0;
+            size_t idx = 0;
+            for(long long i = 0; i < n; i++) {
+                const auto &k = keys[idx];
+                std::tuple<int,int,int> miss(std::get<0>(k), std::get<1>(k) + 100, std::get<2>(k));
+                acc += (blocks.find(miss) != blocks.end());
+                if(++idx == keys.size()) idx = 0;
+            }
+            g_sink = g_sink + acc;
+        });
+        bench("FlatMap lookup hit (64K map)", [&](long long n) {
+            int acc = 0;
+            size_t idx = 0;
+            for(long long i = 0; i < n; i++) {
+                const auto &k = keys[idx];
+                uint64_t key = packBlockKey(std::get<0>(k), std::get<1>(k), std::get<2>(k));
+                acc += (flatBlocks.find(key) != flatBlocks.end());
+                if(++idx == keys.size()) idx = 0;
+            }
+            g_sink = g_sink + acc;
+        });
+        bench("FlatMap lookup miss (64K map)", [&](long long n) {
+            int acc = 0;
+            size_t idx = 0;
+            for(long long i = 0; i < n; i++) {
+                const auto &k = keys[idx];
+                uint64_t miss = packBlockKey(std::get<0>(k), std::get<1>(k) + 100, std::get<2>(k));
+                acc += (flatBlocks.find(miss) != flatBlocks.end());
+                if(++idx == keys.size()) idx = 0;
+            }
+            g_sink = g_sink + acc;
+        });
+        // Building the map from scratch, as loading a world or a chunk's
+        // features does.
+        bench("TupleHash insert (64K map)", [&](long long n) {
+            std::unordered_map<std::tuple<int,int,int>, BlockType, TupleHash> m;
+            for(long long i = 0; i < n; i++) {
+                if(m.size() == keys.size()) m.clear();
+                m[keys[i % keys.size()]] = BLOCK_DIRT;
+            }
+            g_sink = g_sink + (double)m.size();
+        });
+        bench("FlatMap insert (64K map)", [&](long long n) {
+            FlatMap<BlockType> m;
+            for(long long i = 0; i < n; i++) {
+                if(m.size() == keys.size()) m.clear();
+                const auto &k = keys[i % keys.size()];
+                m[packBlockKey(std::get<0>(k), std::get<1>(k), std::get<2>(k))] = BLOCK_DIRT;
+            }
+            g_sink = g_sink + (double)m.size();
+        });
+    }
+    {
+        std::unordered_map<std::pair<int,int>, int, PairHash> chunkMap;
+        FlatMap<int> flatChunks;
+        std::vector<std::pair<int,int>> keys;
+        for(int cx = -6; cx <= 6; cx++)
+            for(int cz = -6; cz <= 6; cz++) {
+                chunkMap[std::make_pair(cx, cz)] = cx * cz;
+                flatChunks[packChunkKey(cx, cz)] = cx * cz;
+                keys.push_back(std::make_pair(cx, cz));
+            }
+        bench("PairHash lookup hit (169 chunks)", [&](long long n) {
+            int acc = 0;
+            size_t idx = 0;
+            for(long long i = 0; i < n; i++) {
+                acc += chunkMap.find(keys[idx])->second;
+                if(++idx == keys.size()) idx = 0;
+            }
+            g_sink = g_sink + acc;
+        });
+        bench("FlatMap lookup hit (169 chunks)", [&](long long n) {
+            int acc = 0;
+            size_t idx = 0;
+            for(long long i = 0; i < n; i++) {
+                acc += flatChunks.find(packChunkKey(keys[idx].first, keys[idx].second))->second;
+                if(++idx == keys.size()) idx = 0;
+            }
+            g_sink = g_sink + acc;
+        });
+    }
+
+    // --- Math ---
+    bench("multiplyMatrix", [](long long n) {
+        Mat4 a = perspectiveMatrix(1.2f, 16.0f / 9.0f, 0.1f, 100.0f);
+        Mat4 b = identityMatrix();
+        b.m[12] = 0.5f;
+        Mat4 acc = identityMatrix();
+        for(long long i = 0; i < n; i++) {
+            acc = multiplyMatrix(a, b);
+            b.m[13] = acc.m[0] * 1e-6f;
+        }
+        g_sink = g_sink + acc.m[5];
+    });
+
+    return 0;
+}
@@ -38,6 +38,7 @@ static int permutation[256];
 // Extended array for indexing: p[i] = permutation[i mod 256].
 static int p[512];
 static bool initialized = false;
+static unsigned int currentSeed = 0;
 
 // Forward declaration for the internal method that re-initializes p[].
 static void initPermutationArray();
@@ -57,6 +58,8 @@ static void initPermutationArray()
 // given seed, then re-initializes p[] from it.
 void setNoiseSeed(unsigned int seed)
 {
+    currentSeed = seed;
+
     // Initialize the pseudo-random generator
     std::srand(seed);
 
@@ -77,6 +80,11 @@ void setNoiseSeed(unsigned int seed)
     initPermutationArray();
 }
 
+unsigned int getNoiseSeed()
+{
+    return currentSeed;
+}
+
 // If the user never calls setNoiseSeed, we use the original classic array.
 static void useDefaultPermutationIfNecessary()
 {
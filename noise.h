@@ -15,4 +15,7 @@ float fbmNoise(float x, float y, int octaves = 4, float lacunarity = 2.0f, float
 // If not called, it uses a default permutation array.
 void setNoiseSeed(unsigned int seed);
 
+// Returns the seed last passed to setNoiseSeed(), or 0 if it was never called.
+unsigned int getNoiseSeed();
+
 #endif // NOISE_H
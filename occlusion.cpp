@@ -0,0 +1,282 @@
+#include "occlusion.h"
+#include "blocks.h"
+#include "profiler.h"
+#include "world.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static const int CHUNK = 16;
+// Clip-space w of the near plane (see worldProjection() in main.cpp);
+// corners closer than this can't be projected.
+static const float NEAR_W = 0.1f;
+
+namespace {
+
+struct ScreenPoint {
+    float x, y;
+};
+
+}
+
+void occlusionClear(OcclusionBuffer &buf)
+{
+    std::fill(buf.depth, buf.depth + OCCLUSION_WIDTH * OCCLUSION_HEIGHT, 1.0f);
+}
+
+// Projects the corners of box into buffer pixels and returns how many of
+// them are behind the near plane. When none are, minDepth/maxDepth are
+// the NDC depth range of the corners.
+static int projectBox(const Mat4 &pv, const OcclusionBox &box, ScreenPoint out[8],
+                      float &minDepth, float &maxDepth) {
+    const float* m = pv.m;
+    minDepth = 1e30f;
+    maxDepth = -1e30f;
+    int behind = 0;
+    for(int i = 0; i < 8; i++) {
+        float x = (i & 1) ? box.max.x : box.min.x;
+        float y = (i & 2) ? box.max.y : box.min.y;
+        float z = (i & 4) ? box.max.z : box.min.z;
+        float w = m[3]*x + m[7]*y + m[11]*z + m[15];
+        if(w < NEAR_W) {
+            behind++;
+            continue;
+        }
+        float inv = 1.0f / w;
+        out[i].x = ((m[0]*x + m[4]*y + m[8]*z + m[12]) * inv * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+        out[i].y = ((m[1]*x + m[5]*y + m[9]*z + m[13]) * inv * 0.5f + 0.5f) * OCCLUSION_HEIGHT;
+        float depth = (m[2]*x + m[6]*y + m[10]*z + m[14]) * inv;
+        minDepth = std::min(minDepth, depth);
+        maxDepth = std::max(maxDepth, depth);
+    }
+    return behind;
+}
+
+static float cross(const ScreenPoint &o, const ScreenPoint &a, const ScreenPoint &b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// Convex hull of the points in counter-clockwise order (monotone chain);
+// returns the number of hull points, written to hull.
+static int convexHull(ScreenPoint pts[8], ScreenPoint hull[16]) {
+    std::sort(pts, pts + 8, [](const ScreenPoint &a, const ScreenPoint &b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    int n = 0;
+    for(int i = 0; i < 8; i++) {
+        while(n >= 2 && cross(hull[n - 2], hull[n - 1], pts[i]) <= 0.0f) n--;
+        hull[n++] = pts[i];
+    }
+    for(int i = 6, lower = n + 1; i >= 0; i--) {
+        while(n >= lower && cross(hull[n - 2], hull[n - 1], pts[i]) <= 0.0f) n--;
+        hull[n++] = pts[i];
+    }
+    return n - 1;
+}
+
+// Pixel range [lo, hi] touched by the span [from, to] of a buffer axis of
+// `size` pixels.
+static void pixelRange(float from, float to, int size, int &lo, int &hi) {
+    lo = std::max(0, (int)std::floor(from));
+    hi = std::min(size - 1, (int)std::ceil(to) - 1);
+}
+
+void occlusionDrawOccluder(OcclusionBuffer &buf, const Mat4 &pv, const OcclusionBox &box)
+{
+    ScreenPoint corners[8], hull[16];
+    float minDepth, maxDepth;
+    if(projectBox(pv, box, corners, minDepth, maxDepth) > 0)
+        return;
+    int n = convexHull(corners, hull);
+    if(n < 3)
+        return;
+
+    // Edge functions a*x + b*y + c, positive inside. A pixel is covered
+    // when the smallest value over its square, at the centre minus
+    // (|a| + |b|) / 2, is still inside for every edge.
+    float a[16], b[16], c[16];
+    float minX = hull[0].x, maxX = hull[0].x, minY = hull[0].y, maxY = hull[0].y;
+    for(int i = 0; i < n; i++) {
+        const ScreenPoint &p = hull[i], &q = hull[(i + 1) % n];
+        a[i] = p.y - q.y;
+        b[i] = q.x - p.x;
+        c[i] = -(a[i] * p.x + b[i] * p.y) - 0.5f * (std::fabs(a[i]) + std::fabs(b[i]));
+        minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+    }
+    int x0, x1, y0, y1;
+    pixelRange(minX, maxX, OCCLUSION_WIDTH, x0, x1);
+    pixelRange(minY, maxY, OCCLUSION_HEIGHT, y0, y1);
+    for(int y = y0; y <= y1; y++) {
+        float py = y + 0.5f;
+        float* row = buf.depth + y * OCCLUSION_WIDTH;
+        for(int x = x0; x <= x1; x++) {
+            float px = x + 0.5f;
+            bool inside = true;
+            for(int i = 0; i < n && inside; i++)
+                inside = a[i] * px + b[i] * py + c[i] >= 0.0f;
+            if(inside && maxDepth < row[x])
+                row[x] = maxDepth;
+        }
+    }
+}
+
+bool occlusionBoxVisible(const OcclusionBuffer &buf, const Mat4 &pv, const OcclusionBox &box)
+{
+    ScreenPoint corners[8];
+    float minDepth, maxDepth;
+    int behind = projectBox(pv, box, corners, minDepth, maxDepth);
+    if(behind > 0)
+        return behind < 8;
+    float minX = corners[0].x, maxX = corners[0].x, minY = corners[0].y, maxY = corners[0].y;
+    for(const ScreenPoint &p : corners) {
+        minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+    }
+    int x0, x1, y0, y1;
+    pixelRange(minX, maxX, OCCLUSION_WIDTH, x0, x1);
+    pixelRange(minY, maxY, OCCLUSION_HEIGHT, y0, y1);
+    for(int y = y0; y <= y1; y++) {
+        const float* row = buf.depth + y * OCCLUSION_WIDTH;
+        for(int x = x0; x <= x1; x++)
+            if(row[x] >= minDepth)
+                return true;
+    }
+    return false;
+}
+
+void occlusionCull(OcclusionBuffer &buf, const Mat4 &pv,
+                   const std::vector<OcclusionBox> &occluders,
+                   const std::vector<OcclusionBox> &queries,
+                   std::vector<uint8_t> &visible)
+{
+    PROFILE_ZONE("occlusionCull");
+    occlusionClear(buf);
+    for(const OcclusionBox &box : occluders)
+        occlusionDrawOccluder(buf, pv, box);
+    visible.resize(queries.size());
+    for(size_t i = 0; i < queries.size(); i++)
+        visible[i] = occlusionBoxVisible(buf, pv, queries[i]);
+}
+
+// Highest y of padded column (px, pz) with only opaque blocks from y = 0
+// up to it, or -1. Edited sections are checked block by block; the rest
+// is natural terrain, solid up to the column top except in oceans.
+static int columnSolidTop(const ChunkColumns &cols, int px, int pz) {
+    Biome biome = cols.biomes[pz][px];
+    if(biome == BIOME_OCEAN)
+        return -1;
+    int top = naturalTopY(biome, cols.heights[pz][px]);
+    int bx = cols.cx * CHUNK + px - 1, bz = cols.cz * CHUNK + pz - 1;
+    for(int sy = 0; sy <= getSectionY(top); sy++) {
+        if(!sectionEditCount(cols.cx, sy, cols.cz))
+            continue;
+        int yEnd = std::min(top, sy * CHUNK + CHUNK - 1);
+        for(int y = sy * CHUNK; y <= yEnd; y++) {
+            uint64_t key = packBlockKey(bx, y, bz);
+            auto it = extraBlocks.find(key);
+            bool solid = waterLevels.find(key) == waterLevels.end() &&
+                         (it == extraBlocks.end() ||
+                          ((int)it->second >= 0 && blockInfo(it->second).layer == LAYER_OPAQUE));
+            if(!solid)
+                return y - 1;
+        }
+    }
+    return top;
+}
+
+void buildChunkOccluders(const ChunkColumns &cols, std::vector<OcclusionBox> &out)
+{
+    for(int i = 0; i < CHUNK; i += OCCLUDER_CELL) {
+        for(int j = 0; j < CHUNK; j += OCCLUDER_CELL) {
+            int top = 1 << 30;
+            for(int dz = 0; dz < OCCLUDER_CELL; dz++)
+                for(int dx = 0; dx < OCCLUDER_CELL; dx++)
+                    top = std::min(top, columnSolidTop(cols, j + dx + 1, i + dz + 1));
+            if(top < 0)
+                continue;
+            float x = (float)(cols.cx * CHUNK + j), z = (float)(cols.cz * CHUNK + i);
+            out.push_back(OcclusionBox{ { x, 0.0f, z },
+                                        { x + OCCLUDER_CELL, (float)(top + 1), z + OCCLUDER_CELL } });
+        }
+    }
+}
+
+// --- Worker thread ---
+
+static std::thread s_worker;
+static std::mutex s_mutex;
+static std::condition_variable s_wake;   // a job was submitted, or quit
+static std::condition_variable s_done;   // the job finished
+static bool s_hasJob = false, s_busy = false, s_quit = false;
+static Mat4 s_pv;
+static std::vector<OcclusionBox> s_occluders, s_queries;
+static std::vector<uint8_t> s_visible;
+static OcclusionBuffer s_buffer;
+static float s_lastMs = 0.0f;
+
+static void workerMain() {
+    profilerSetThreadName("occlusion worker");
+    std::unique_lock<std::mutex> lock(s_mutex);
+    while(true) {
+        s_wake.wait(lock, [] { return s_hasJob || s_quit; });
+        if(s_quit)
+            return;
+        s_hasJob = false;
+        lock.unlock();
+        uint64_t start = profilerNowNs();
+        occlusionCull(s_buffer, s_pv, s_occluders, s_queries, s_visible);
+        float ms = (profilerNowNs() - start) / 1.0e6f;
+        lock.lock();
+        s_lastMs = ms;
+        s_busy = false;
+        s_done.notify_all();
+    }
+}
+
+void occlusionStartWorker()
+{
+    if(s_worker.joinable()) return;
+    s_quit = false;
+    s_worker = std::thread(workerMain);
+}
+
+void occlusionStopWorker()
+{
+    if(!s_worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_quit = true;
+    }
+    s_wake.notify_one();
+    s_worker.join();
+}
+
+void occlusionSubmit(const Mat4 &pv, std::vector<OcclusionBox> &occluders,
+                     std::vector<OcclusionBox> &queries)
+{
+    std::unique_lock<std::mutex> lock(s_mutex);
+    s_done.wait(lock, [] { return !s_busy; });
+    s_pv = pv;
+    s_occluders.swap(occluders);
+    s_queries.swap(queries);
+    s_hasJob = true;
+    s_busy = true;
+    s_wake.notify_one();
+}
+
+const std::vector<uint8_t> &occlusionWait()
+{
+    PROFILE_ZONE("occlusionWait");
+    std::unique_lock<std::mutex> lock(s_mutex);
+    s_done.wait(lock, [] { return !s_busy; });
+    return s_visible;
+}
+
+float occlusionLastMs()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_lastMs;
+}
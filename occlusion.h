@@ -0,0 +1,79 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include "math.h"
+#include "mesher.h"
+#include <cstdint>
+#include <vector>
+
+// Software occlusion culling. Boxes known to be solid (occluders) are
+// drawn into a small CPU depth buffer, then the bounding box of each
+// section (a query) is tested against it: a query is hidden when every
+// buffer pixel its screen rectangle touches holds something nearer than
+// the nearest point of the box.
+//
+// Both sides are conservative, so a visible section is never culled:
+//  - an occluder only covers pixels its silhouette covers entirely, at the
+//    depth of its farthest corner;
+//  - a query covers every pixel its silhouette touches, at the depth of
+//    its nearest corner.
+// Anything that crosses the near plane is skipped as an occluder and
+// always visible as a query; a query entirely behind it is hidden.
+// Queries entirely off screen come out hidden, so the test also does
+// frustum culling.
+//
+// The depth buffer is in NDC z (-1 near .. 1 far), at a fixed resolution
+// that is stretched over the whole viewport.
+
+static const int OCCLUSION_WIDTH = 160;
+static const int OCCLUSION_HEIGHT = 90;
+// Occluders are built from cells of OCCLUDER_CELL x OCCLUDER_CELL columns,
+// for the chunks within OCCLUDER_RADIUS of the eye's.
+static const int OCCLUDER_CELL = 4;
+static const int OCCLUDER_RADIUS = 4;
+
+struct OcclusionBox {
+    Vec3 min, max;
+};
+
+struct OcclusionBuffer {
+    float depth[OCCLUSION_WIDTH * OCCLUSION_HEIGHT];   // row 0 at the bottom
+};
+
+void occlusionClear(OcclusionBuffer &buf);
+void occlusionDrawOccluder(OcclusionBuffer &buf, const Mat4 &pv, const OcclusionBox &box);
+bool occlusionBoxVisible(const OcclusionBuffer &buf, const Mat4 &pv, const OcclusionBox &box);
+
+// Draws every occluder into a cleared buffer, then sets visible[i] to
+// whether queries[i] may be visible.
+void occlusionCull(OcclusionBuffer &buf, const Mat4 &pv,
+                   const std::vector<OcclusionBox> &occluders,
+                   const std::vector<OcclusionBox> &queries,
+                   std::vector<uint8_t> &visible);
+
+// Appends the occluders of a chunk: for each cell, a box from y = 0 up to
+// the lowest column top of the cell, where a column's top is the highest
+// block below which nothing has been dug out or replaced by something
+// that doesn't occlude. Reads the world maps, so call it from the thread
+// that edits them.
+void buildChunkOccluders(const ChunkColumns &cols, std::vector<OcclusionBox> &out);
+
+// A worker thread that runs occlusionCull() for the caller, so culling a
+// frame can overlap the rest of the frame's CPU work.
+void occlusionStartWorker();
+void occlusionStopWorker();
+
+// Hands the worker a job. The vectors are swapped with the worker's own,
+// so they come back holding an earlier job's boxes. Waits for the
+// previous job first if it is still running.
+void occlusionSubmit(const Mat4 &pv, std::vector<OcclusionBox> &occluders,
+                     std::vector<OcclusionBox> &queries);
+
+// Waits for the submitted job and returns its result, indexed like its
+// queries. Valid until the next occlusionSubmit().
+const std::vector<uint8_t> &occlusionWait();
+
+// Worker time spent on the last finished job, in milliseconds.
+float occlusionLastMs();
+
+#endif // OCCLUSION_H
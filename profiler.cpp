@@ -0,0 +1,152 @@
+#include "profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> g_profilerEnabled(false);
+
+// Number of zones kept per thread; older zones are overwritten.
+static const size_t RING_CAPACITY = 1 << 16;
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t    startNs;
+    uint64_t    endNs;
+};
+
+// One ring per thread. Only the owning thread writes; the writer publishes
+// each event by bumping `written`, so a reader sees complete events as long
+// as the writer doesn't lap it mid-dump.
+struct ThreadRing {
+    std::vector<ProfileEvent> events;
+    std::atomic<uint64_t>     written;
+    int                       tid;
+    std::string               name;
+    ThreadRing() : events(RING_CAPACITY), written(0), tid(0) {}
+};
+
+// Rings are never freed: a thread may exit before the trace is written.
+static std::mutex               s_ringsMutex;
+static std::vector<ThreadRing*> s_rings;
+static thread_local ThreadRing* t_ring = nullptr;
+// Name for the calling thread's ring, given before the ring exists.
+static thread_local const char* t_name = nullptr;
+
+static const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+static ThreadRing* registerRing(const char* name)
+{
+    ThreadRing* ring = new ThreadRing();
+    if(name) ring->name = name;
+    std::lock_guard<std::mutex> lock(s_ringsMutex);
+    ring->tid = (int)s_rings.size() + 1;
+    s_rings.push_back(ring);
+    return ring;
+}
+
+static ThreadRing* threadRing()
+{
+    if(!t_ring)
+        t_ring = registerRing(t_name);
+    return t_ring;
+}
+
+static void pushEvent(ThreadRing* ring, const char* name, uint64_t startNs, uint64_t endNs)
+{
+    uint64_t n = ring->written.load(std::memory_order_relaxed);
+    ProfileEvent &ev = ring->events[n % RING_CAPACITY];
+    ev.name = name;
+    ev.startNs = startNs;
+    ev.endNs = endNs;
+    ring->written.store(n + 1, std::memory_order_release);
+}
+
+uint64_t profilerNowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - s_epoch).count();
+}
+
+void profilerSetEnabled(bool enabled)
+{
+    g_profilerEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void profilerClear()
+{
+    std::lock_guard<std::mutex> lock(s_ringsMutex);
+    for(ThreadRing* ring : s_rings)
+        ring->written.store(0, std::memory_order_release);
+}
+
+void profilerRecord(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    pushEvent(threadRing(), name, startNs, endNs);
+}
+
+void profilerRecordGpu(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    static ThreadRing* s_gpuRing = registerRing("GPU");
+    pushEvent(s_gpuRing, name, startNs, endNs);
+}
+
+void profilerSetThreadName(const char* name)
+{
+    t_name = name;
+    if(t_ring) {
+        // The trace writer reads names under the same lock.
+        std::lock_guard<std::mutex> lock(s_ringsMutex);
+        t_ring->name = name;
+    }
+}
+
+// Zone names are literals from our own code, but keep the JSON valid anyway.
+static void writeJsonString(FILE* f, const char* s)
+{
+    fputc('"', f);
+    for(; *s; s++) {
+        if(*s == '"' || *s == '\\') fputc('\\', f);
+        if((unsigned char)*s >= 0x20) fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+bool profilerWriteChromeTrace(const char* filename)
+{
+    FILE* f = fopen(filename, "w");
+    if(!f) {
+        std::cerr << "[Profiler] Could not open '" << filename << "'\n";
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(s_ringsMutex);
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    size_t total = 0;
+    for(ThreadRing* ring : s_rings) {
+        if(!ring->name.empty()) {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                    first ? "" : ",\n", ring->tid);
+            writeJsonString(f, ring->name.c_str());
+            fprintf(f, "}}");
+            first = false;
+        }
+        uint64_t written = ring->written.load(std::memory_order_acquire);
+        uint64_t begin = written > RING_CAPACITY ? written - RING_CAPACITY : 0;
+        for(uint64_t i = begin; i < written; i++) {
+            const ProfileEvent &ev = ring->events[i % RING_CAPACITY];
+            fprintf(f, "%s{\"name\":", first ? "" : ",\n");
+            writeJsonString(f, ev.name);
+            fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    ring->tid, ev.startNs / 1000.0, (ev.endNs - ev.startNs) / 1000.0);
+            first = false;
+            total++;
+        }
+    }
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    std::cout << "[Profiler] Wrote " << total << " zones to " << filename << "\n";
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lightweight scoped CPU profiler.
+//
+// PROFILE_ZONE("name") records the time spent in the enclosing scope into a
+// per-thread ring buffer. While capture is disabled a zone costs one relaxed
+// atomic load. Captured zones can be written out as Chrome trace JSON
+// (load the file in chrome://tracing or https://ui.perfetto.dev).
+//
+// Zone names must be string literals (or otherwise outlive the profiler).
+// Build with -DVOXEL_NO_PROFILER to compile every zone out entirely.
+
+extern std::atomic<bool> g_profilerEnabled;
+
+inline bool profilerEnabled() { return g_profilerEnabled.load(std::memory_order_relaxed); }
+
+// Starts or stops capturing zones. Buffers are kept until profilerClear().
+void profilerSetEnabled(bool enabled);
+
+// Empties every thread's buffer. The rings are reset without telling
+// their writers, so call it only while capture is disabled and no other
+// thread is inside a zone (workers idle).
+void profilerClear();
+
+// Monotonic timestamp in nanoseconds, shared by all threads.
+uint64_t profilerNowNs();
+
+// Records a finished zone on the calling thread's ring buffer.
+void profilerRecord(const char* name, uint64_t startNs, uint64_t endNs);
+
+// Records a zone on the shared "GPU" track. Used for GPU timer results,
+// which arrive a frame late; startNs is the CPU time the work was submitted.
+// Must only be called from the thread that owns the GL context.
+void profilerRecordGpu(const char* name, uint64_t startNs, uint64_t endNs);
+
+// Names the calling thread in trace output (e.g. "main", "mesh worker 2").
+// The thread's buffer is still only allocated by its first captured zone.
+void profilerSetThreadName(const char* name);
+
+// Writes all buffered zones from every thread as Chrome trace JSON.
+bool profilerWriteChromeTrace(const char* filename);
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : m_name(profilerEnabled() ? name : nullptr)
+        , m_start(m_name ? profilerNowNs() : 0) {}
+    ~ProfileScope() {
+        if(m_name) profilerRecord(m_name, m_start, profilerNowNs());
+    }
+private:
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+    const char* m_name;
+    uint64_t    m_start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef VOXEL_NO_PROFILER
+#define PROFILE_ZONE(name) ((void)0)
+#else
+#define PROFILE_ZONE(name) ProfileScope PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#endif
+
+#endif // PROFILER_H
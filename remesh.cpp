@@ -0,0 +1,69 @@
+#include "remesh.h"
+#include "coords.h"
+#include "flatmap.h"
+#include "profiler.h"
+#include <algorithm>
+#include <vector>
+
+// Queued sections by packBlockKey(cx, sy, cz); the values are unused.
+static FlatMap<char> s_queued;
+
+void remeshMarkSection(int cx, int sy, int cz)
+{
+    if(sy < 0) return;
+    s_queued.insert(std::make_pair(packBlockKey(cx, sy, cz), (char)0));
+}
+
+void remeshMarkBlock(int bx, int by, int bz)
+{
+    int cx, cz;
+    getChunkCoords(bx, bz, cx, cz);
+    int sy = getSectionY(by);
+    int lx = bx - cx * 16, ly = by - sy * 16, lz = bz - cz * 16;
+    remeshMarkSection(cx, sy, cz);
+    if(lx == 0)  remeshMarkSection(cx - 1, sy, cz);
+    if(lx == 15) remeshMarkSection(cx + 1, sy, cz);
+    if(ly == 0)  remeshMarkSection(cx, sy - 1, cz);
+    if(ly == 15) remeshMarkSection(cx, sy + 1, cz);
+    if(lz == 0)  remeshMarkSection(cx, sy, cz - 1);
+    if(lz == 15) remeshMarkSection(cx, sy, cz + 1);
+}
+
+int remeshDrain(float x, float y, float z, float budgetMs,
+                void (*rebuild)(int cx, int sy, int cz))
+{
+    if(s_queued.empty()) return 0;
+    PROFILE_ZONE("remeshDrain");
+    uint64_t start = profilerNowNs();
+    uint64_t budgetNs = (uint64_t)(budgetMs * 1.0e6f);
+
+    // Squared distance from (x, y, z) to each section's centre.
+    std::vector<std::pair<float, uint64_t>> order;
+    order.reserve(s_queued.size());
+    for(const auto &entry : s_queued) {
+        int cx, sy, cz;
+        unpackBlockKey(entry.first, cx, sy, cz);
+        float dx = cx * 16 + 8 - x;
+        float dy = sy * 16 + 8 - y;
+        float dz = cz * 16 + 8 - z;
+        order.push_back(std::make_pair(dx * dx + dy * dy + dz * dz, entry.first));
+    }
+    std::sort(order.begin(), order.end());
+
+    int built = 0;
+    for(const auto &entry : order) {
+        if(built > 0 && profilerNowNs() - start >= budgetNs)
+            break;
+        int cx, sy, cz;
+        unpackBlockKey(entry.second, cx, sy, cz);
+        s_queued.erase(entry.second);
+        rebuild(cx, sy, cz);
+        built++;
+    }
+    return built;
+}
+
+size_t remeshPending()
+{
+    return s_queued.size();
+}
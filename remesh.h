@@ -0,0 +1,28 @@
+#ifndef REMESH_H
+#define REMESH_H
+
+#include <cstddef>
+
+// Queue of sections whose mesh is out of date. Edits only mark sections
+// here; the game rebuilds them in remeshDrain(), nearest to the player
+// first, within a per-frame time budget. Marking a section that is
+// already queued is free, so a burst of edits to one section costs a
+// single rebuild.
+
+void remeshMarkSection(int cx, int sy, int cz);
+
+// Marks the section holding a changed block, plus every neighbouring
+// section the block touches across a boundary: the faces those sections
+// draw against it may have appeared or disappeared.
+void remeshMarkBlock(int bx, int by, int bz);
+
+// Rebuilds queued sections, nearest to (x, y, z) first, by calling
+// rebuild(cx, sy, cz) until budgetMs has been used. At least one section
+// is rebuilt per call so the queue always makes progress. Returns the
+// number rebuilt.
+int remeshDrain(float x, float y, float z, float budgetMs,
+                void (*rebuild)(int cx, int sy, int cz));
+
+size_t remeshPending();
+
+#endif // REMESH_H
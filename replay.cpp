@@ -0,0 +1,255 @@
+#include "replay.h"
+#include "stats.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// File layout (native endianness; recordings are meant to be replayed by
+// the same build on the same kind of machine):
+//   header: "VXRP", uint32 version, ReplayStart
+//   frame:  float dt, uint32 eventCount, SDL_Event[eventCount],
+//           uint16 keyCount, uint16 scancode[keyCount]
+static const char     REPLAY_MAGIC[4] = { 'V', 'X', 'R', 'P' };
+static const uint32_t REPLAY_VERSION  = 1;
+
+enum InputMode { INPUT_LIVE, INPUT_RECORD, INPUT_REPLAY };
+
+static InputMode s_mode = INPUT_LIVE;
+static FILE*     s_file = nullptr;
+
+// The frame being recorded or replayed.
+static float                 s_frameDt = 0.0f;
+static std::vector<SDL_Event> s_frameEvents;
+static size_t                s_nextEvent = 0;
+static std::vector<uint16_t> s_frameKeys;
+static bool                  s_keysSampled = false;
+static bool                  s_framePending = false;
+static Uint8                 s_replayKeys[SDL_NUM_SCANCODES];
+
+// Only these reach the game logic; window and text events are not recorded.
+static bool isRecordedEvent(const SDL_Event &ev) {
+    switch(ev.type) {
+        case SDL_QUIT:
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void flushRecordedFrame() {
+    if(!s_framePending) return;
+    uint32_t eventCount = (uint32_t)s_frameEvents.size();
+    uint16_t keyCount = (uint16_t)s_frameKeys.size();
+    fwrite(&s_frameDt, sizeof(s_frameDt), 1, s_file);
+    fwrite(&eventCount, sizeof(eventCount), 1, s_file);
+    if(eventCount)
+        fwrite(s_frameEvents.data(), sizeof(SDL_Event), eventCount, s_file);
+    fwrite(&keyCount, sizeof(keyCount), 1, s_file);
+    if(keyCount)
+        fwrite(s_frameKeys.data(), sizeof(uint16_t), keyCount, s_file);
+    s_framePending = false;
+}
+
+static bool readReplayFrame() {
+    uint32_t eventCount = 0;
+    uint16_t keyCount = 0;
+    if(fread(&s_frameDt, sizeof(s_frameDt), 1, s_file) != 1 ||
+       fread(&eventCount, sizeof(eventCount), 1, s_file) != 1)
+        return false;
+    s_frameEvents.resize(eventCount);
+    if(eventCount && fread(s_frameEvents.data(), sizeof(SDL_Event), eventCount, s_file) != eventCount)
+        return false;
+    if(fread(&keyCount, sizeof(keyCount), 1, s_file) != 1)
+        return false;
+    s_frameKeys.resize(keyCount);
+    if(keyCount && fread(s_frameKeys.data(), sizeof(uint16_t), keyCount, s_file) != keyCount)
+        return false;
+    s_nextEvent = 0;
+    std::memset(s_replayKeys, 0, sizeof(s_replayKeys));
+    for(uint16_t sc : s_frameKeys)
+        if(sc < SDL_NUM_SCANCODES)
+            s_replayKeys[sc] = 1;
+    return true;
+}
+
+bool inputStartRecording(const char* filename, const ReplayStart &start)
+{
+    inputClose();
+    s_file = fopen(filename, "wb");
+    if(!s_file) {
+        std::cerr << "[Replay] Can't write " << filename << "\n";
+        return false;
+    }
+    fwrite(REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC), s_file);
+    fwrite(&REPLAY_VERSION, sizeof(REPLAY_VERSION), 1, s_file);
+    fwrite(&start, sizeof(start), 1, s_file);
+    s_mode = INPUT_RECORD;
+    std::cout << "[Replay] Recording to " << filename << "\n";
+    return true;
+}
+
+bool inputStartReplay(const char* filename, ReplayStart &start)
+{
+    inputClose();
+    s_file = fopen(filename, "rb");
+    if(!s_file) {
+        std::cerr << "[Replay] Can't read " << filename << "\n";
+        return false;
+    }
+    char magic[4];
+    uint32_t version = 0;
+    if(fread(magic, 1, sizeof(magic), s_file) != sizeof(magic) ||
+       std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0 ||
+       fread(&version, sizeof(version), 1, s_file) != 1 || version != REPLAY_VERSION ||
+       fread(&start, sizeof(start), 1, s_file) != 1) {
+        std::cerr << "[Replay] " << filename << " is not a version "
+                  << REPLAY_VERSION << " recording\n";
+        fclose(s_file);
+        s_file = nullptr;
+        return false;
+    }
+    s_mode = INPUT_REPLAY;
+    std::cout << "[Replay] Replaying " << filename << " (seed " << start.seed << ")\n";
+    return true;
+}
+
+void inputClose()
+{
+    if(s_mode == INPUT_RECORD)
+        flushRecordedFrame();
+    if(s_file)
+        fclose(s_file);
+    s_file = nullptr;
+    s_mode = INPUT_LIVE;
+}
+
+bool inputRecording() { return s_mode == INPUT_RECORD; }
+bool inputReplaying() { return s_mode == INPUT_REPLAY; }
+
+bool inputBeginFrame(float &dt)
+{
+    if(s_mode == INPUT_RECORD) {
+        flushRecordedFrame();
+        s_frameDt = dt;
+        s_frameEvents.clear();
+        s_frameKeys.clear();
+        s_keysSampled = false;
+        s_framePending = true;
+    }
+    else if(s_mode == INPUT_REPLAY) {
+        if(!readReplayFrame())
+            return false;
+        dt = s_frameDt;
+    }
+    return true;
+}
+
+int inputPollEvent(SDL_Event* ev)
+{
+    if(s_mode == INPUT_REPLAY) {
+        // Keep the window responsive, but only let the user quit.
+        SDL_Event live;
+        while(SDL_PollEvent(&live)) {
+            if(live.type == SDL_QUIT) {
+                *ev = live;
+                return 1;
+            }
+        }
+        if(s_nextEvent >= s_frameEvents.size())
+            return 0;
+        *ev = s_frameEvents[s_nextEvent++];
+        return 1;
+    }
+    int got = SDL_PollEvent(ev);
+    if(got && s_mode == INPUT_RECORD && isRecordedEvent(*ev))
+        s_frameEvents.push_back(*ev);
+    return got;
+}
+
+const Uint8* inputKeyboardState()
+{
+    if(s_mode == INPUT_REPLAY)
+        return s_replayKeys;
+    const Uint8* keys = SDL_GetKeyboardState(nullptr);
+    if(s_mode == INPUT_RECORD && !s_keysSampled) {
+        for(int sc = 0; sc < SDL_NUM_SCANCODES; sc++)
+            if(keys[sc])
+                s_frameKeys.push_back((uint16_t)sc);
+        s_keysSampled = true;
+    }
+    return keys;
+}
+
+// --- Timing CSV ---
+
+static FILE*              s_csv = nullptr;
+static unsigned long long s_csvFrame = 0;
+static std::vector<float> s_csvFrameMs;
+static unsigned long long s_csvSamples = 0;
+static unsigned long long s_lastGenerated = 0, s_lastRebuilt = 0;
+
+bool timingsOpen(const char* filename)
+{
+    timingsClose();
+    s_csv = fopen(filename, "w");
+    if(!s_csv) {
+        std::cerr << "[Timings] Can't write " << filename << "\n";
+        return false;
+    }
+    fprintf(s_csv, "frame,dt_ms,frame_ms,gen_ms,mesh_ms,water_ms,render_ms,gpu_world_ms,"
+                   "chunks_generated,chunks_rebuilt,draw_calls,vertices,upload_mb,render_distance,"
+                   "world_samples,culled_sections,mesh_arena_growths\n");
+    s_csvFrame = 0;
+    s_csvFrameMs.clear();
+    s_csvSamples = 0;
+    s_lastGenerated = g_perf.chunksGenerated;
+    s_lastRebuilt = g_perf.chunksRebuilt;
+    std::cout << "[Timings] Writing per-frame timings to " << filename << "\n";
+    return true;
+}
+
+void timingsWriteFrame(float dtMs, float frameMs, float gpuWorldMs,
+                       unsigned long long worldSamples)
+{
+    if(!s_csv) return;
+    fprintf(s_csv, "%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%d,%lld,%.3f,%d,%llu,%d,%d\n",
+            s_csvFrame, dtMs, frameMs, g_perf.genMs, g_perf.meshMs, g_perf.waterMs,
+            g_perf.renderMs, gpuWorldMs,
+            g_perf.chunksGenerated - s_lastGenerated, g_perf.chunksRebuilt - s_lastRebuilt,
+            g_perf.drawCalls, g_perf.verticesSubmitted, g_perf.uploadBytes / (1024.0 * 1024.0),
+            g_perf.renderDistance, worldSamples, g_perf.culledSections,
+            g_perf.meshArenaGrowths);
+    s_csvSamples += worldSamples;
+    s_lastGenerated = g_perf.chunksGenerated;
+    s_lastRebuilt = g_perf.chunksRebuilt;
+    s_csvFrameMs.push_back(frameMs);
+    s_csvFrame++;
+}
+
+void timingsClose()
+{
+    if(!s_csv) return;
+    fclose(s_csv);
+    s_csv = nullptr;
+    if(s_csvFrameMs.empty()) return;
+
+    std::vector<float> sorted = s_csvFrameMs;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for(float ms : sorted) total += ms;
+    auto pct = [&sorted](int p) {
+        return sorted[std::min(sorted.size() - 1, sorted.size() * p / 100)];
+    };
+    printf("[Timings] %zu frames: mean %.2f ms, p50 %.2f, p90 %.2f, p99 %.2f, max %.2f, "
+           "%.0f world samples\n",
+           sorted.size(), total / sorted.size(), pct(50), pct(90), pct(99), sorted.back(),
+           (double)s_csvSamples / sorted.size());
+}
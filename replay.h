@@ -0,0 +1,52 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <SDL2/SDL.h>
+
+// Input recording and deterministic replay, plus per-frame timing output.
+//
+// --record=<file> stores every frame's dt, the input events the game reacts
+// to and the keyboard state it sampled. --replay=<file> feeds those back
+// instead of live input, stepping the simulation with the recorded dt so
+// the flythrough is identical however fast the replaying machine renders.
+// Both start from a fresh world (the saved world is neither loaded nor
+// written) with the seed and camera stored in the recording.
+//
+// Clicks inside the inventory and pause menu read the live mouse position
+// and are not replayed.
+
+struct ReplayStart {
+    unsigned int seed;
+    float x, y, z;
+    float yaw, pitch;
+};
+
+bool inputStartRecording(const char* filename, const ReplayStart &start);
+// Reads the recording header into start.
+bool inputStartReplay(const char* filename, ReplayStart &start);
+void inputClose();
+
+bool inputRecording();
+bool inputReplaying();
+
+// Call once at the top of every frame. While recording, dt is stored;
+// while replaying, it is replaced by the recorded value. Returns false when
+// the replay has run out of frames.
+bool inputBeginFrame(float &dt);
+
+// Drop-in replacements for SDL_PollEvent and SDL_GetKeyboardState. While
+// replaying, live events other than SDL_QUIT are discarded.
+int inputPollEvent(SDL_Event* ev);
+const Uint8* inputKeyboardState();
+
+// Per-frame timing CSV: one row per frame with the CPU time spent in
+// generation, meshing, water and rendering, the mesh data uploaded, the
+// render distance, culled sections and mesh arena growths (from g_perf)
+// and the GPU time and samples passed of the world pass. timingsClose()
+// prints frame time percentiles and mean world samples for the run.
+bool timingsOpen(const char* filename);
+void timingsWriteFrame(float dtMs, float frameMs, float gpuWorldMs,
+                       unsigned long long worldSamples);
+void timingsClose();
+
+#endif // REPLAY_H
@@ -0,0 +1,66 @@
+#include "stats.h"
+#include <algorithm>
+#include <vector>
+
+PerfCounters g_perf = {};
+
+// Roughly four seconds of history at 60 FPS.
+static const int FRAME_HISTORY = 240;
+static float s_frameMs[FRAME_HISTORY];
+static int   s_frameCount = 0;
+static int   s_frameHead  = 0;
+
+// One-second window used for the per-second rates.
+static float s_windowMs = 0.0f;
+static unsigned long long s_windowGenerated = 0, s_windowRebuilt = 0;
+static float s_generatedPerSec = 0.0f, s_rebuiltPerSec = 0.0f;
+
+void statsBeginFrame(float frameMs)
+{
+    s_frameMs[s_frameHead] = frameMs;
+    s_frameHead = (s_frameHead + 1) % FRAME_HISTORY;
+    if(s_frameCount < FRAME_HISTORY) s_frameCount++;
+
+    s_windowMs += frameMs;
+    if(s_windowMs >= 1000.0f) {
+        float seconds = s_windowMs / 1000.0f;
+        s_generatedPerSec = (g_perf.chunksGenerated - s_windowGenerated) / seconds;
+        s_rebuiltPerSec = (g_perf.chunksRebuilt - s_windowRebuilt) / seconds;
+        s_windowGenerated = g_perf.chunksGenerated;
+        s_windowRebuilt = g_perf.chunksRebuilt;
+        s_windowMs = 0.0f;
+    }
+
+    g_perf.drawCalls = 0;
+    g_perf.verticesSubmitted = 0;
+    g_perf.visibleChunks = 0;
+    g_perf.visibleLodChunks = 0;
+    g_perf.culledSections = 0;
+    g_perf.genMs = 0.0f;
+    g_perf.meshMs = 0.0f;
+    g_perf.waterMs = 0.0f;
+    g_perf.renderMs = 0.0f;
+    g_perf.meshArenaGrowths = 0;
+    g_perf.uploadBytes = 0;
+}
+
+PerfSummary statsSummary()
+{
+    PerfSummary s = {};
+    s.chunksGeneratedPerSec = s_generatedPerSec;
+    s.chunksRebuiltPerSec = s_rebuiltPerSec;
+    if(s_frameCount == 0) return s;
+
+    std::vector<float> sorted(s_frameMs, s_frameMs + s_frameCount);
+    float total = 0.0f;
+    for(float ms : sorted) total += ms;
+    s.fps = total > 0.0f ? 1000.0f * s_frameCount / total : 0.0f;
+
+    size_t p50 = sorted.size() / 2;
+    size_t p99 = std::min(sorted.size() - 1, (sorted.size() * 99) / 100);
+    std::nth_element(sorted.begin(), sorted.begin() + p50, sorted.end());
+    s.frameMsP50 = sorted[p50];
+    std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+    s.frameMsP99 = sorted[p99];
+    return s;
+}
@@ -0,0 +1,69 @@
+#ifndef STATS_H
+#define STATS_H
+
+// Engine-wide performance counters shown by the HUD.
+
+struct PerfCounters {
+    // Reset at the start of every frame by statsBeginFrame().
+    int       drawCalls;
+    long long verticesSubmitted;
+    int       visibleChunks;
+    int       visibleLodChunks;
+    // Sections within the render distance skipped by occlusion culling
+    // (which also culls to the frustum, see occlusion.h).
+    int       culledSections;
+
+    // CPU milliseconds spent this frame in chunk generation (terrain and
+    // features), meshing, water simulation and render submission.
+    float genMs;
+    float meshMs;
+    float waterMs;
+    float renderMs;
+
+    // Times a mesh arena had to grow its storage while meshing this
+    // frame (see mesharena.h); zero once the arenas have warmed up.
+    int meshArenaGrowths;
+
+    // Mesh data written to GPU buffers this frame (see upload.h).
+    long long uploadBytes;
+
+    // Running totals, turned into per-second rates by statsSummary().
+    // chunksRebuilt counts remeshed sections.
+    unsigned long long chunksGenerated;
+    unsigned long long chunksRebuilt;
+
+    // Water cells examined by the last updateWaterFlow() tick.
+    int activeWaterCells;
+
+    // Sections still waiting in the remesh queue after the last drain.
+    int remeshPending;
+
+    // Chunks still waiting in the load queue this frame.
+    int loadPending;
+
+    // Section meshes still waiting for upload after this frame's flush.
+    int uploadPending;
+
+    // Full-resolution render distance in chunks this frame (see
+    // viewdistance.h).
+    int renderDistance;
+};
+
+extern PerfCounters g_perf;
+
+struct PerfSummary {
+    float fps;
+    float frameMsP50;
+    float frameMsP99;
+    float chunksGeneratedPerSec;
+    float chunksRebuiltPerSec;
+};
+
+// Records the duration of the previous frame and resets per-frame counters.
+void statsBeginFrame(float frameMs);
+
+// FPS and frame time percentiles over the recent frame history; generation
+// rates over the last full one-second window.
+PerfSummary statsSummary();
+
+#endif // STATS_H
@@ -0,0 +1,169 @@
+#include "terrain.h"
+#include "blocks.h"
+#include "noise.h"
+#include "world.h"
+#include <cmath>
+
+Biome getBiome(int x, int z) {
+    float oceanNoise = perlinNoise(x * 0.001f, z * 0.001f);
+    if(oceanNoise < -0.8f)
+        return BIOME_OCEAN;
+    float freq1 = 0.0035f, freq2 = 0.0037f;
+    float n1 = perlinNoise(x * freq1, z * freq1);
+    float n2 = perlinNoise((x+1000)*freq2, (z+1000)*freq2);
+    float combined = 0.5f * (n1 + n2);
+    if(combined < -0.4f)
+        return BIOME_DESERT;
+    else if(combined < -0.1f)
+        return BIOME_PLAINS;
+    else if(combined < 0.2f)
+        return BIOME_FOREST;
+    else
+        return BIOME_EXTREME_HILLS;
+}
+
+static int heightForBiome(int x, int z, Biome b) {
+    if(b == BIOME_OCEAN)
+        return 8;
+    if(b == BIOME_EXTREME_HILLS) {
+        float freq = 0.0007f;
+        int octaves = 8;
+        float lacunarity = 2.3f, gain = 0.5f;
+        float n = fbmNoise(x * freq, z * freq, octaves, lacunarity, gain);
+        float normalized = 0.5f * (n + 1.0f);
+        if(normalized < 0.0f) normalized = 0.0f;
+        if(normalized > 1.0f) normalized = 1.0f;
+        return (int)(powf(normalized, 2.0f) * 40.0f);
+    } else {
+        float n = fbmNoise(x * 0.01f, z * 0.01f, 6, 2.0f, 0.5f);
+        float normalized = 0.5f * (n + 1.0f);
+        return (int)(normalized * 24.0f);
+    }
+}
+
+int getTerrainHeightAt(int x, int z) {
+    return heightForBiome(x, z, getBiome(x, z));
+}
+
+TerrainColumn sampleTerrainColumn(int x, int z) {
+    TerrainColumn col;
+    col.biome = getBiome(x, z);
+    col.height = heightForBiome(x, z, col.biome);
+    return col;
+}
+
+BlockType terrainBlockAt(Biome biome, int height, int y) {
+    if(biome == BIOME_DESERT) {
+        const int sandLayers = 2, dirtLayers = 3;
+        if(y >= height - sandLayers)
+            return BLOCK_SAND;
+        else if(y >= height - (sandLayers + dirtLayers))
+            return BLOCK_DIRT;
+        return BLOCK_STONE;
+    }
+    if(y == height)
+        return BLOCK_GRASS;
+    else if((height - y) <= 6)
+        return BLOCK_DIRT;
+    return BLOCK_STONE;
+}
+
+BlockType naturalBlockAt(Biome biome, int height, int y) {
+    if(biome == BIOME_OCEAN) {
+        if(y < 0) return BLOCK_NONE;
+        if(y < OCEAN_WATER_LAYERS) return BLOCK_WATER;
+        if(y == OCEAN_WATER_LAYERS) return BLOCK_SAND;
+        if(y == OCEAN_WATER_LAYERS + 1) return BLOCK_BEDROCK;
+        return BLOCK_NONE;
+    }
+    if(y < 0 || y > height) return BLOCK_NONE;
+    return terrainBlockAt(biome, height, y);
+}
+
+// Looks up one registry flag for the block at (bx, by, bz). Placed and
+// removed blocks come from extraBlocks, water cells from waterLevels, and
+// anything else at or below the column height is natural terrain, which is
+// always an opaque solid.
+static bool blockFlagAt(int bx, int by, int bz, bool BlockInfo::*flag) {
+    uint64_t key = packBlockKey(bx, by, bz);
+    auto it = extraBlocks.find(key);
+    if(it != extraBlocks.end()){
+        BlockType t = it->second;
+        if((int)t < 0) return false;
+        return blockInfo(t).*flag;
+    }
+    if(waterLevels.find(key) != waterLevels.end())
+        return blockInfo(BLOCK_WATER).*flag;
+    int h = getTerrainHeightAt(bx, bz);
+    return (by >= 0 && by <= h);
+}
+
+bool isSolidBlock(int bx, int by, int bz) {
+    return blockFlagAt(bx, by, bz, &BlockInfo::collision);
+}
+
+bool isTargetBlock(int bx, int by, int bz) {
+    return blockFlagAt(bx, by, bz, &BlockInfo::targetable);
+}
+
+bool isOccludingBlock(int bx, int by, int bz) {
+    return blockFlagAt(bx, by, bz, &BlockInfo::occludes);
+}
+
+// Small per-chunk PRNG so tree placement doesn't depend on the global
+// rand() state (which made it differ between runs and threads).
+static unsigned int nextRandom(unsigned int &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void populateChunk(int cx, int cz, ChunkFeatures &out) {
+    out.blocks.clear();
+    out.waterSources.clear();
+    unsigned int rng = (unsigned int)(cx * 73856093u ^ cz * 19349663u) ^ getNoiseSeed();
+    if(rng == 0) rng = 0x9E3779B9u;
+    for(int lx = 0; lx < 16; lx++){
+        for(int lz = 0; lz < 16; lz++){
+            int wx = cx * 16 + lx;
+            int wz = cz * 16 + lz;
+            TerrainColumn col = sampleTerrainColumn(wx, wz);
+            if(col.biome == BIOME_OCEAN) {
+                for(int y = 0; y < OCEAN_WATER_LAYERS; y++)
+                    out.waterSources.push_back(std::make_tuple(wx, y, wz));
+                continue;
+            }
+            int chance = 0;
+            if(col.biome == BIOME_FOREST) chance = 5;
+            else if(col.biome == BIOME_PLAINS) chance = 50;
+            else if(col.biome == BIOME_EXTREME_HILLS) chance = 80;
+            if(chance > 0 && (nextRandom(rng) % chance == 0)) {
+                int trunkH = 4 + (nextRandom(rng) % 3);
+                int baseY = col.height + 1;
+                for(int ty = baseY; ty < baseY + trunkH; ty++)
+                    out.blocks.push_back(std::make_pair(std::make_tuple(wx, ty, wz), BLOCK_TREE_LOG));
+                int topY = baseY + trunkH - 1;
+                for(int lx2 = wx - 1; lx2 <= wx + 1; lx2++){
+                    for(int lz2 = wz - 1; lz2 <= wz + 1; lz2++){
+                        if(lx2 == wx && lz2 == wz)
+                            continue;
+                        out.blocks.push_back(std::make_pair(std::make_tuple(lx2, topY, lz2), BLOCK_LEAVES));
+                    }
+                }
+                out.blocks.push_back(std::make_pair(std::make_tuple(wx, topY + 1, wz), BLOCK_LEAVES));
+            }
+        }
+    }
+}
+
+void applyChunkFeatures(const ChunkFeatures &features) {
+    for(const auto &b : features.blocks) {
+        int x, y, z;
+        std::tie(x, y, z) = b.first;
+        if(extraBlocks.find(packBlockKey(x, y, z)) == extraBlocks.end())
+            setExtraBlock(x, y, z, b.second);
+    }
+    for(const auto &w : features.waterSources)
+        setWaterLevel(std::get<0>(w), std::get<1>(w), std::get<2>(w), 8);
+}
@@ -0,0 +1,65 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "cube.h"
+
+// Procedural terrain: biomes, column heights and the features (trees,
+// ocean water) placed when a chunk is first generated. Everything here
+// depends only on the noise seed, so it is safe to call from any thread.
+
+// Biome definitions.
+enum Biome {
+    BIOME_PLAINS,
+    BIOME_DESERT,
+    BIOME_EXTREME_HILLS,
+    BIOME_FOREST,
+    BIOME_OCEAN
+};
+
+// Number of water layers (y = 0..5) in ocean columns, which are topped by
+// one layer of sand and one of bedrock.
+static const int OCEAN_WATER_LAYERS = 6;
+
+Biome getBiome(int x, int z);
+int getTerrainHeightAt(int x, int z);
+
+// Biome and height of a column, sampling the biome noise only once.
+struct TerrainColumn {
+    Biome biome;
+    int   height;
+};
+TerrainColumn sampleTerrainColumn(int x, int z);
+
+// Natural block at height y (0 <= y <= height) of a non-ocean column.
+BlockType terrainBlockAt(Biome biome, int height, int y);
+
+// Natural block at y in any column, or BLOCK_NONE for air. Ocean columns
+// are water below OCEAN_WATER_LAYERS, then a layer of sand and one of
+// bedrock.
+BlockType naturalBlockAt(Biome biome, int height, int y);
+
+// Highest natural block of a column.
+inline int naturalTopY(Biome biome, int height) {
+    return biome == BIOME_OCEAN ? OCEAN_WATER_LAYERS + 1 : height;
+}
+
+// Features placed when a chunk is generated. May reach one block into
+// neighbouring chunks (tree canopies).
+struct ChunkFeatures {
+    std::vector<std::pair<std::tuple<int,int,int>, BlockType>> blocks;
+    std::vector<std::tuple<int,int,int>> waterSources;
+};
+
+// Computes a chunk's features without touching the world maps.
+// Deterministic for a given noise seed and chunk position.
+void populateChunk(int cx, int cz, ChunkFeatures &out);
+
+// Writes features into extraBlocks/waterLevels. Existing extraBlocks
+// entries win, so edits saved with the world (e.g. a felled tree) aren't
+// undone when the chunk is regenerated. Not thread-safe.
+void applyChunkFeatures(const ChunkFeatures &features);
+
+#endif // TERRAIN_H
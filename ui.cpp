@@ -0,0 +1,176 @@
+#include "ui.h"
+#include "shader.h"
+#include "math.h"
+#include "stats.h"
+#include <vector>
+
+// Shared with inventory.cpp and main.cpp.
+GLuint uiShader = 0;
+
+static GLuint s_vao = 0, s_vbo = 0;
+static GLint  s_projLoc = -1, s_texLoc = -1;
+static int    s_screenW = 1, s_screenH = 1;
+
+// Vertex layout: position (2), UV (2), colour (4), textured flag (1).
+static const int UI_VERTEX_FLOATS = 9;
+
+// A run of queued vertices drawn with one texture bound.
+// texture == 0 means the run so far is untextured and can adopt any texture.
+struct UIDrawCmd {
+    GLuint texture;
+    int firstVertex;
+    int vertexCount;
+};
+
+static std::vector<float>     s_vertices;
+static std::vector<UIDrawCmd> s_cmds;
+
+static const char* uiVertSrc = R"(
+#version 330 core
+layout(location=0) in vec2 aPos;
+layout(location=1) in vec2 aTex;
+layout(location=2) in vec4 aColor;
+layout(location=3) in float aTextured;
+uniform mat4 uProj;
+out vec2 TexCoord;
+out vec4 Color;
+out float Textured;
+void main(){
+    gl_Position = uProj * vec4(aPos, 0.0, 1.0);
+    TexCoord = aTex;
+    Color = aColor;
+    Textured = aTextured;
+}
+)";
+
+static const char* uiFragSrc = R"(
+#version 330 core
+in vec2 TexCoord;
+in vec4 Color;
+in float Textured;
+out vec4 FragColor;
+uniform sampler2D uTexture;
+void main(){
+    vec4 c = Color;
+    if(Textured > 0.5)
+        c *= texture(uTexture, TexCoord);
+    FragColor = c;
+}
+)";
+
+void uiInit()
+{
+    uiShader = createShaderProgram(uiVertSrc, uiFragSrc);
+    s_projLoc = glGetUniformLocation(uiShader, "uProj");
+    s_texLoc  = glGetUniformLocation(uiShader, "uTexture");
+
+    glGenVertexArrays(1, &s_vao);
+    glGenBuffers(1, &s_vbo);
+    glBindVertexArray(s_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
+    GLsizei stride = UI_VERTEX_FLOATS * sizeof(float);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(2*sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)(4*sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (void*)(8*sizeof(float)));
+    glEnableVertexAttribArray(3);
+    glBindVertexArray(0);
+
+    s_vertices.reserve(256 * 6 * UI_VERTEX_FLOATS);
+}
+
+void uiShutdown()
+{
+    glDeleteProgram(uiShader);
+    glDeleteVertexArrays(1, &s_vao);
+    glDeleteBuffers(1, &s_vbo);
+    uiShader = s_vao = s_vbo = 0;
+}
+
+void uiBegin(int screenW, int screenH)
+{
+    s_screenW = screenW;
+    s_screenH = screenH;
+    s_vertices.clear();
+    s_cmds.clear();
+}
+
+static void pushQuad(float x, float y, float w, float h, GLuint tex,
+                     float u0, float v0, float u1, float v1,
+                     float r, float g, float b, float a)
+{
+    // Extend the current run unless it is bound to a different texture.
+    if(s_cmds.empty() || (tex && s_cmds.back().texture && s_cmds.back().texture != tex)) {
+        UIDrawCmd cmd = { tex, (int)(s_vertices.size() / UI_VERTEX_FLOATS), 0 };
+        s_cmds.push_back(cmd);
+    } else if(tex) {
+        s_cmds.back().texture = tex;
+    }
+
+    float t = tex ? 1.0f : 0.0f;
+    float x1 = x + w, y1 = y + h;
+    float quad[6 * UI_VERTEX_FLOATS] = {
+        x,  y,  u0, v0, r, g, b, a, t,
+        x1, y,  u1, v0, r, g, b, a, t,
+        x1, y1, u1, v1, r, g, b, a, t,
+        x,  y,  u0, v0, r, g, b, a, t,
+        x1, y1, u1, v1, r, g, b, a, t,
+        x,  y1, u0, v1, r, g, b, a, t
+    };
+    s_vertices.insert(s_vertices.end(), quad, quad + 6 * UI_VERTEX_FLOATS);
+    s_cmds.back().vertexCount += 6;
+}
+
+void uiRect(float x, float y, float w, float h,
+            float r, float g, float b, float a)
+{
+    pushQuad(x, y, w, h, 0, 0.0f, 0.0f, 0.0f, 0.0f, r, g, b, a);
+}
+
+void uiTexturedRect(float x, float y, float w, float h, GLuint tex,
+                    float u0, float v0, float u1, float v1,
+                    float r, float g, float b, float a)
+{
+    pushQuad(x, y, w, h, tex, u0, v0, u1, v1, r, g, b, a);
+}
+
+void uiFlush()
+{
+    if(!s_cmds.empty()) {
+        Mat4 proj = {};
+        proj.m[0]  = 2.0f/(float)s_screenW;
+        proj.m[5]  = 2.0f/(float)s_screenH;
+        proj.m[10] = -1.0f;
+        proj.m[15] = 1.0f;
+        proj.m[12] = -1.0f;
+        proj.m[13] = -1.0f;
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(uiShader);
+        glUniformMatrix4fv(s_projLoc, 1, GL_FALSE, proj.m);
+        glUniform1i(s_texLoc, 0);
+        glActiveTexture(GL_TEXTURE0);
+
+        glBindVertexArray(s_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
+        // Orphan the previous frame's storage so the driver never has to wait on it.
+        glBufferData(GL_ARRAY_BUFFER, s_vertices.size() * sizeof(float), s_vertices.data(), GL_STREAM_DRAW);
+        for(const UIDrawCmd &cmd : s_cmds) {
+            if(cmd.texture)
+                glBindTexture(GL_TEXTURE_2D, cmd.texture);
+            glDrawArrays(GL_TRIANGLES, cmd.firstVertex, cmd.vertexCount);
+            g_perf.drawCalls++;
+            g_perf.verticesSubmitted += cmd.vertexCount;
+        }
+        glBindVertexArray(0);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+    }
+    s_vertices.clear();
+    s_cmds.clear();
+}
@@ -0,0 +1,33 @@
+#ifndef UI_H
+#define UI_H
+
+#include <GL/glew.h>
+
+// Batched immediate-mode 2D renderer.
+// Rectangles are queued in pixel coordinates ((0,0) is the bottom-left of
+// the screen) and drawn by uiFlush() from a single dynamic vertex buffer,
+// with one draw call per texture change. Untextured rectangles never break
+// a batch.
+
+// Compiles the UI shader (uiShader) and creates the shared vertex buffer.
+void uiInit();
+void uiShutdown();
+
+// Starts a new frame of UI; sets the screen size used by the projection.
+void uiBegin(int screenW, int screenH);
+
+// Queues a solid colour rectangle.
+void uiRect(float x, float y, float w, float h,
+            float r, float g, float b, float a);
+
+// Queues a textured rectangle sampling [u0,u1]x[v0,v1] of tex,
+// modulated by the given colour.
+void uiTexturedRect(float x, float y, float w, float h, GLuint tex,
+                    float u0, float v0, float u1, float v1,
+                    float r = 1.0f, float g = 1.0f, float b = 1.0f, float a = 1.0f);
+
+// Draws everything queued since the last flush and empties the queue.
+// Leaves depth testing enabled and blending disabled.
+void uiFlush();
+
+#endif // UI_H
@@ -0,0 +1,215 @@
+#include "upload.h"
+#include "coords.h"
+#include "flatmap.h"
+#include "profiler.h"
+#include "stats.h"
+#include <cstring>
+#include <deque>
+#include <iostream>
+
+// The staging ring has one segment per frame in flight. A frame writes
+// only into its own segment, and before a segment is reused the fence
+// placed after its last copy must have signalled.
+static const int RING_SEGMENTS = 3;
+// Spare mesh buffers kept for reuse; beyond this they are freed.
+static const size_t MAX_SPARE_BUFFERS = 64;
+
+namespace {
+
+struct PendingMesh {
+    std::vector<float> verts;   // all layers, back to back
+    GLsizei layerVertices[RENDER_LAYER_COUNT];
+};
+
+// An entry of the upload order: a section by packBlockKey(cx, sy, cz), or
+// a LOD mesh by packChunkKey(cx, cz).
+struct QueuedMesh {
+    uint64_t key;
+    bool lod;
+};
+
+}
+
+static size_t s_budget = 0;
+static std::deque<QueuedMesh> s_order;
+static FlatMap<PendingMesh> s_pending, s_pendingLod;
+// Queued section meshes per chunk, by packChunkKey(cx, cz).
+static FlatMap<int> s_chunkSections;
+static std::vector<std::vector<float>> s_spare;
+
+static GLuint s_ring = 0;
+static char*  s_ringPtr = nullptr;
+static GLsync s_segmentFence[RING_SEGMENTS] = {};
+static int    s_segment = 0;
+
+void uploadInit(size_t budgetBytes)
+{
+    s_budget = budgetBytes;
+    if(!GLEW_ARB_buffer_storage) {
+        std::cout << "[Upload] GL_ARB_buffer_storage not available, orphaning buffers\n";
+        return;
+    }
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr size = (GLsizeiptr)(s_budget * RING_SEGMENTS);
+    glGenBuffers(1, &s_ring);
+    glBindBuffer(GL_COPY_READ_BUFFER, s_ring);
+    glBufferStorage(GL_COPY_READ_BUFFER, size, nullptr, flags);
+    s_ringPtr = (char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, flags);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    if(!s_ringPtr) {
+        std::cout << "[Upload] Can't map the staging ring, orphaning buffers\n";
+        glDeleteBuffers(1, &s_ring);
+        s_ring = 0;
+        return;
+    }
+    std::cout << "[Upload] " << RING_SEGMENTS << " x " << s_budget / 1024
+              << " KiB persistently mapped staging ring\n";
+}
+
+void uploadShutdown()
+{
+    for(GLsync &fence : s_segmentFence) {
+        if(fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if(s_ring) {
+        glBindBuffer(GL_COPY_READ_BUFFER, s_ring);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &s_ring);
+    }
+    s_ring = 0;
+    s_ringPtr = nullptr;
+    s_order.clear();
+    s_pending.clear();
+    s_pendingLod.clear();
+    s_chunkSections.clear();
+    s_spare.clear();
+}
+
+// The queued entry for key in `pending`, emptied, queued at the back of
+// the upload order if it is new.
+static PendingMesh &queueEntry(FlatMap<PendingMesh> &pending, uint64_t key, bool lod) {
+    bool queued = pending.find(key) != pending.end();
+    PendingMesh &entry = pending[key];
+    if(!queued) {
+        if(!s_spare.empty()) {
+            entry.verts = std::move(s_spare.back());
+            s_spare.pop_back();
+        }
+        s_order.push_back(QueuedMesh{ key, lod });
+    }
+    entry.verts.clear();
+    return entry;
+}
+
+void uploadQueueSection(int cx, int sy, int cz, const LayeredMesh &mesh)
+{
+    uint64_t key = packBlockKey(cx, sy, cz);
+    if(s_pending.find(key) == s_pending.end())
+        s_chunkSections[packChunkKey(cx, cz)]++;
+    PendingMesh &pending = queueEntry(s_pending, key, false);
+    for(int l = 0; l < RENDER_LAYER_COUNT; l++) {
+        const MeshArena &layer = mesh.layers[l];
+        pending.verts.insert(pending.verts.end(), layer.data(), layer.data() + layer.size());
+        pending.layerVertices[l] = (GLsizei)(layer.size() / 5);
+    }
+}
+
+void uploadQueueLod(int cx, int cz, const MeshArena &mesh)
+{
+    PendingMesh &pending = queueEntry(s_pendingLod, packChunkKey(cx, cz), true);
+    pending.verts.assign(mesh.data(), mesh.data() + mesh.size());
+    pending.layerVertices[0] = (GLsizei)(mesh.size() / 5);
+}
+
+bool uploadChunkPending(int cx, int cz)
+{
+    return s_chunkSections.find(packChunkKey(cx, cz)) != s_chunkSections.end();
+}
+
+// Replaces the contents of vbo with verts, through this frame's ring
+// segment (starting at segmentBase, `staged` bytes already used) while it
+// has room, otherwise by orphaning.
+static void writeBuffer(GLuint vbo, const std::vector<float> &verts,
+                        size_t segmentBase, size_t &staged) {
+    size_t bytes = verts.size() * sizeof(float);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STATIC_DRAW);
+    if(s_ring && staged + bytes <= s_budget) {
+        std::memcpy(s_ringPtr + segmentBase + staged, verts.data(), bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, s_ring);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            (GLintptr)(segmentBase + staged), 0, (GLsizeiptr)bytes);
+        staged += bytes;
+    }
+    else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)bytes, verts.data());
+    }
+}
+
+void uploadFlush(UploadTargetFn target, LodUploadTargetFn lodTarget)
+{
+    if(s_order.empty()) return;
+    PROFILE_ZONE("uploadFlush");
+
+    // Claim this frame's ring segment.
+    size_t segmentBase = 0;
+    if(s_ring) {
+        s_segment = (s_segment + 1) % RING_SEGMENTS;
+        GLsync &fence = s_segmentFence[s_segment];
+        if(fence) {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        segmentBase = (size_t)s_segment * s_budget;
+    }
+
+    size_t written = 0, staged = 0;
+    while(!s_order.empty()) {
+        QueuedMesh queued = s_order.front();
+        FlatMap<PendingMesh> &map = queued.lod ? s_pendingLod : s_pending;
+        auto it = map.find(queued.key);
+        size_t bytes = it->second.verts.size() * sizeof(float);
+        if(written > 0 && written + bytes > s_budget)
+            break;
+        s_order.pop_front();
+        PendingMesh pending = std::move(it->second);
+        map.erase(queued.key);
+        std::vector<float> &verts = pending.verts;
+
+        GLuint vbo;
+        if(queued.lod) {
+            int cx, cz;
+            unpackChunkKey(queued.key, cx, cz);
+            vbo = lodTarget(cx, cz, pending.layerVertices[0]);
+        }
+        else {
+            int cx, sy, cz;
+            unpackBlockKey(queued.key, cx, sy, cz);
+            uint64_t chunkKey = packChunkKey(cx, cz);
+            if(--s_chunkSections[chunkKey] == 0)
+                s_chunkSections.erase(chunkKey);
+            vbo = target(cx, sy, cz, pending.layerVertices);
+        }
+        if(vbo && bytes > 0) {
+            writeBuffer(vbo, verts, segmentBase, staged);
+            written += bytes;
+        }
+        if(s_spare.size() < MAX_SPARE_BUFFERS) {
+            verts.clear();
+            s_spare.push_back(std::move(verts));
+        }
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    if(staged > 0)
+        s_segmentFence[s_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    g_perf.uploadBytes += written;
+}
+
+size_t uploadPending()
+{
+    return s_order.size();
+}
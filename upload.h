@@ -0,0 +1,55 @@
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+#include <GL/glew.h>
+#include "mesher.h"
+#include <cstddef>
+#include <vector>
+
+// Section and LOD mesh uploads, spread over frames so that a burst of new
+// meshes doesn't stall one frame in glBufferData.
+//
+// Meshes are queued with uploadQueueSection() and written into their
+// vertex buffers by uploadFlush(), oldest first, within a per-frame byte
+// budget; the rest stay queued for the next frame. With
+// GL_ARB_buffer_storage the data goes through a persistently mapped
+// staging ring and is copied into place on the GPU; without it each
+// buffer is orphaned and refilled with glBufferSubData. Either way the
+// driver never waits for a buffer an earlier frame still draws from.
+
+// Call once the GL entry points are loaded. budgetBytes is the per-frame
+// upload budget; it also sizes the staging ring.
+void uploadInit(size_t budgetBytes);
+void uploadShutdown();
+
+// Queues a copy of the mesh of section (cx, sy, cz), replacing any mesh
+// still queued for it. The layers are stored back to back in RenderLayer
+// order in one vertex buffer. Copies go into pooled buffers that are
+// reused once uploaded, so the mesher can build the next mesh in the same
+// scratch space.
+void uploadQueueSection(int cx, int sy, int cz, const LayeredMesh &mesh);
+
+// Queues a copy of the LOD mesh of chunk (cx, cz) the same way, replacing
+// any LOD mesh still queued for it.
+void uploadQueueLod(int cx, int cz, const MeshArena &mesh);
+
+// Whether any section mesh of chunk (cx, cz) is still queued.
+bool uploadChunkPending(int cx, int cz);
+
+// Asked for the vertex buffer of a section right before its mesh is
+// written, and given the vertex count of each layer so the caller can
+// update its draw state. Returns 0 to drop the upload (the section is
+// gone or has nothing to draw).
+typedef GLuint (*UploadTargetFn)(int cx, int sy, int cz,
+                                 const GLsizei layerVertices[RENDER_LAYER_COUNT]);
+// The same for the LOD mesh of chunk (cx, cz).
+typedef GLuint (*LodUploadTargetFn)(int cx, int cz, GLsizei vertexCount);
+
+// Writes queued meshes until the budget is used; at least one per call so
+// oversized meshes still get through. Adds the bytes written to
+// g_perf.uploadBytes.
+void uploadFlush(UploadTargetFn target, LodUploadTargetFn lodTarget);
+
+size_t uploadPending();
+
+#endif // UPLOAD_H
@@ -0,0 +1,35 @@
+#include "viewdistance.h"
+
+// Weight of the newest frame in the moving average: about a 20-frame
+// window, so a single hitch doesn't change the distance.
+static const float AVERAGE_WEIGHT = 0.05f;
+
+void viewDistanceInit(ViewDistanceController &c, int distance,
+                      int minDistance, int maxDistance, float targetMs)
+{
+    c.distance = distance;
+    c.minDistance = minDistance;
+    c.maxDistance = maxDistance;
+    c.targetMs = targetMs;
+    c.averageMs = targetMs * VIEW_RAISE_FRACTION;
+    c.holdFrames = VIEW_HOLD_FRAMES;
+}
+
+bool viewDistanceUpdate(ViewDistanceController &c, float busyMs)
+{
+    c.averageMs += (busyMs - c.averageMs) * AVERAGE_WEIGHT;
+    if(c.holdFrames > 0) {
+        c.holdFrames--;
+        return false;
+    }
+    int next = c.distance;
+    if(c.averageMs > c.targetMs && c.distance > c.minDistance)
+        next = c.distance - 1;
+    else if(c.averageMs < c.targetMs * VIEW_RAISE_FRACTION && c.distance < c.maxDistance)
+        next = c.distance + 1;
+    if(next == c.distance)
+        return false;
+    c.distance = next;
+    c.holdFrames = VIEW_HOLD_FRAMES;
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef VIEWDISTANCE_H
+#define VIEWDISTANCE_H
+
+// Adjusts the chunk render distance to hold a frame-time target. Feed it
+// each frame's busy time (CPU work excluding the wait for vsync, or the
+// GPU world pass if that took longer): it keeps a moving average and
+// steps the distance by one chunk
+//  - down when the average is over the target,
+//  - up when it is under VIEW_RAISE_FRACTION of the target,
+// then holds the new distance for VIEW_HOLD_FRAMES so the chunks it
+// loads or drops, and the average itself, can settle before the next
+// decision. The gap between the two thresholds keeps the distance from
+// oscillating around a level that is just affordable.
+
+static const float VIEW_RAISE_FRACTION = 0.6f;
+static const int   VIEW_HOLD_FRAMES = 90;
+
+struct ViewDistanceController {
+    int   distance;
+    int   minDistance, maxDistance;
+    float targetMs;
+    float averageMs;   // exponential moving average of busy time
+    int   holdFrames;  // frames left before the next change
+};
+
+void viewDistanceInit(ViewDistanceController &c, int distance,
+                      int minDistance, int maxDistance, float targetMs);
+
+// Records one frame's busy time. Returns true if c.distance changed.
+bool viewDistanceUpdate(ViewDistanceController &c, float busyMs);
+
+#endif // VIEWDISTANCE_H
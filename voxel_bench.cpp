@@ -0,0 +1,325 @@
+// Headless world generation/meshing benchmark. Links only libvoxelcore.a
+// (no SDL, no GL) so it can run on build machines and in CI.
+//
+//   ./voxel_bench [--seed N] [--radius R] [--threads T] [--center CX CZ]
+//
+// Generates every chunk within R of chunk (CX, CZ) (default the origin;
+// the default seed has ocean around chunk (30, -530)) the same way the game does
+// (features in parallel, applied serially, then meshed in parallel) and
+// reports throughput and allocation counts for each phase. Then checks
+// the face count of every chunk's mesh against a block-by-block reference,
+// and culls the sections against the terrain, on the occlusion worker,
+// from a player standing in the centre chunk looking in OCCLUSION_VIEWS
+// directions.
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "blocks.h"
+#include "columnpack.h"
+#include "coords.h"
+#include "mesher.h"
+#include "noise.h"
+#include "occlusion.h"
+#include "terrain.h"
+#include "world.h"
+
+// Count every heap allocation so regressions in the mesher's allocation
+// behaviour show up in the numbers.
+static std::atomic<unsigned long long> g_allocCount(0);
+static std::atomic<unsigned long long> g_allocBytes(0);
+
+void* operator new(std::size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete[](void *p) noexcept { std::free(p); }
+
+static double nowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs fn(i) for i in [0, count) on `threads` threads, handing out indices
+// from a shared counter.
+template <typename Fn>
+static void parallelFor(int count, int threads, Fn fn) {
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for(int i = next++; i < count; i = next++)
+            fn(i);
+    };
+    std::vector<std::thread> pool;
+    for(int t = 1; t < threads; t++)
+        pool.push_back(std::thread(worker));
+    worker();
+    for(auto &th : pool)
+        th.join();
+}
+
+struct PhaseResult {
+    double seconds;
+    unsigned long long allocs;
+    unsigned long long allocBytes;
+};
+
+template <typename Fn>
+static PhaseResult runPhase(Fn fn) {
+    unsigned long long a0 = g_allocCount.load(), b0 = g_allocBytes.load();
+    double t0 = nowSeconds();
+    fn();
+    PhaseResult r;
+    r.seconds = nowSeconds() - t0;
+    r.allocs = g_allocCount.load() - a0;
+    r.allocBytes = g_allocBytes.load() - b0;
+    return r;
+}
+
+static void printPhase(const char *name, const PhaseResult &r, int chunks) {
+    std::printf("%-10s %8.2f ms  %9.1f chunks/s  %8.1f allocs/chunk  %9.1f KiB alloc/chunk\n",
+                name, r.seconds * 1000.0, chunks / (r.seconds > 0 ? r.seconds : 1e-9),
+                (double)r.allocs / chunks, (double)r.allocBytes / chunks / 1024.0);
+}
+
+namespace {
+
+struct ReferenceCell {
+    BlockType type;
+    bool occludes;
+};
+
+}
+
+// One block of the world resolved on its own, the slow way: placed and
+// removed blocks, then water, then natural terrain from cols (padded
+// column px, pz).
+static ReferenceCell referenceCell(const ChunkColumns &cols, int px, int y, int pz) {
+    uint64_t key = packBlockKey(cols.cx * 16 + px - 1, y, cols.cz * 16 + pz - 1);
+    bool water = waterLevels.find(key) != waterLevels.end();
+    auto it = extraBlocks.find(key);
+    BlockType type;
+    if(it != extraBlocks.end())
+        type = (int)it->second < 0 ? BLOCK_NONE : it->second;
+    else if(water)
+        type = BLOCK_WATER;
+    else
+        type = naturalBlockAt(cols.biomes[pz][px], cols.heights[pz][px], y);
+    ReferenceCell cell = { water ? BLOCK_WATER : type,
+                           type != BLOCK_NONE && blockInfo(type).occludes };
+    return cell;
+}
+
+// Faces of chunk (cx, cz) per render layer, counted block by block: a face
+// shows unless the block next to it occludes, or both blocks are water.
+static void referenceFaces(int cx, int cz, size_t faces[RENDER_LAYER_COUNT]) {
+    static const int dirs[6][3] = { {0,0,1}, {0,0,-1}, {-1,0,0}, {1,0,0}, {0,1,0}, {0,-1,0} };
+    ChunkColumns cols;
+    sampleChunkColumns(cx, cz, cols);
+    for(int l = 0; l < RENDER_LAYER_COUNT; l++)
+        faces[l] = 0;
+    int top = chunkSectionCount(cols) * 16;
+    for(int y = 0; y < top; y++) {
+        for(int pz = 1; pz <= 16; pz++) {
+            for(int px = 1; px <= 16; px++) {
+                ReferenceCell cell = referenceCell(cols, px, y, pz);
+                if(cell.type == BLOCK_NONE)
+                    continue;
+                for(const auto &d : dirs) {
+                    ReferenceCell next = referenceCell(cols, px + d[0], y + d[1], pz + d[2]);
+                    if(next.occludes || (cell.type == BLOCK_WATER && next.type == BLOCK_WATER))
+                        continue;
+                    faces[blockInfo(cell.type).layer]++;
+                }
+            }
+        }
+    }
+}
+
+static const int OCCLUSION_VIEWS = 8;
+
+struct OcclusionResult {
+    int inFrustum, hidden, tested;   // hidden counts only sections in the frustum
+    size_t occluders;
+    double workerMs;
+};
+
+// Culls every section of the chunks against the occluders of the chunks
+// around the centre one, looking horizontally from 1.6 blocks above the
+// ground at the centre of chunk (centerX, centerZ).
+static OcclusionResult runOcclusion(const std::vector<std::pair<int,int>> &coords,
+                                    int centerX, int centerZ, int radius) {
+    OcclusionResult result = { 0, 0, 0, 0, 0.0 };
+    std::vector<OcclusionBox> chunkOccluders, queries, occluders;
+    for(const auto &c : coords) {
+        ChunkColumns cols;
+        sampleChunkColumns(c.first, c.second, cols);
+        if(std::abs(c.first - centerX) <= OCCLUDER_RADIUS && std::abs(c.second - centerZ) <= OCCLUDER_RADIUS)
+            buildChunkOccluders(cols, chunkOccluders);
+        for(int sy = 0; sy < chunkSectionCount(cols); sy++) {
+            Vec3 lo = { c.first * 16.0f, sy * 16.0f, c.second * 16.0f };
+            queries.push_back(OcclusionBox{ lo, { lo.x + 16.0f, lo.y + 16.0f, lo.z + 16.0f } });
+        }
+    }
+    result.occluders = chunkOccluders.size();
+
+    float eyeX = centerX * 16.0f + 8.0f, eyeZ = centerZ * 16.0f + 8.0f;
+    TerrainColumn ground = sampleTerrainColumn((int)eyeX, (int)eyeZ);
+    Vec3 eye = { eyeX, naturalTopY(ground.biome, ground.height) + 1.0f + 1.6f, eyeZ };
+    Mat4 proj = perspectiveMatrix(45.0f * (3.14159f / 180.0f), 1280.0f / 720.0f,
+                                  0.1f, (radius + 1) * 16.0f * 1.5f);
+    occlusionStartWorker();
+    for(int v = 0; v < OCCLUSION_VIEWS; v++) {
+        float yaw = v * 2.0f * 3.14159f / OCCLUSION_VIEWS;
+        Vec3 target = { eye.x + std::cos(yaw), eye.y, eye.z + std::sin(yaw) };
+        Mat4 pv = multiplyMatrix(proj, lookAtMatrix(eye, target, { 0, 1, 0 }));
+        occluders = chunkOccluders;
+        std::vector<OcclusionBox> viewQueries = queries;
+        occlusionSubmit(pv, occluders, viewQueries);
+        const std::vector<uint8_t> &visible = occlusionWait();
+        Frustum frustum = frustumFromMatrix(pv);
+        for(size_t i = 0; i < queries.size(); i++) {
+            if(!frustumIntersectsBox(frustum, queries[i].min, queries[i].max))
+                continue;
+            result.inFrustum++;
+            result.hidden += !visible[i];
+        }
+        result.tested += (int)queries.size();
+        result.workerMs += occlusionLastMs();
+    }
+    occlusionStopWorker();
+    return result;
+}
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr, "usage: %s [--seed N] [--radius R] [--threads T] [--center CX CZ]\n", argv0);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int seed = 12345;
+    int radius = 6;
+    int centerX = 0, centerZ = 0;
+    int threads = (int)std::thread::hardware_concurrency();
+    if(threads < 1) threads = 1;
+
+    for(int i = 1; i < argc; i++) {
+        if(i + 1 < argc && std::strcmp(argv[i], "--seed") == 0)
+            seed = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if(i + 1 < argc && std::strcmp(argv[i], "--radius") == 0)
+            radius = std::atoi(argv[++i]);
+        else if(i + 1 < argc && std::strcmp(argv[i], "--threads") == 0)
+            threads = std::atoi(argv[++i]);
+        else if(i + 2 < argc && std::strcmp(argv[i], "--center") == 0) {
+            centerX = std::atoi(argv[++i]);
+            centerZ = std::atoi(argv[++i]);
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if(radius < 0 || threads < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    setNoiseSeed(seed);
+    clearWorldEdits();
+
+    std::vector<std::pair<int,int>> coords;
+    for(int cx = centerX - radius; cx <= centerX + radius; cx++)
+        for(int cz = centerZ - radius; cz <= centerZ + radius; cz++)
+            coords.push_back(std::make_pair(cx, cz));
+    int count = (int)coords.size();
+
+    std::vector<ChunkFeatures> features(count);
+    std::vector<size_t> meshFloats(count), translucentFloats(count);
+    std::vector<size_t> layerFaces(count * RENDER_LAYER_COUNT);
+
+    PhaseResult populate = runPhase([&]() {
+        parallelFor(count, threads, [&](int i) {
+            populateChunk(coords[i].first, coords[i].second, features[i]);
+        });
+    });
+    PhaseResult apply = runPhase([&]() {
+        for(int i = 0; i < count; i++)
+            applyChunkFeatures(features[i]);
+    });
+    PhaseResult mesh = runPhase([&]() {
+        parallelFor(count, threads, [&](int i) {
+            LayeredMesh &mesh = threadLayeredMesh();
+            buildChunkMesh(coords[i].first, coords[i].second, mesh);
+            meshFloats[i] = mesh.size();
+            translucentFloats[i] = mesh.layers[LAYER_TRANSLUCENT].size();
+            for(int l = 0; l < RENDER_LAYER_COUNT; l++)
+                layerFaces[i * RENDER_LAYER_COUNT + l] = mesh.layers[l].size() / FACE_FLOATS;
+        });
+    });
+
+    // Chunks whose face count in some layer differs from the reference.
+    std::atomic<int> mismatched(0);
+    std::atomic<long long> facesOff(0);
+    parallelFor(count, threads, [&](int i) {
+        size_t faces[RENDER_LAYER_COUNT];
+        referenceFaces(coords[i].first, coords[i].second, faces);
+        long long off = 0;
+        for(int l = 0; l < RENDER_LAYER_COUNT; l++)
+            off += std::llabs((long long)layerFaces[i * RENDER_LAYER_COUNT + l] - (long long)faces[l]);
+        if(off) {
+            mismatched++;
+            facesOff += off;
+        }
+    });
+
+    // Resident size of the chunks' columns when cold (see columnpack.h).
+    size_t packedBytes = 0;
+    for(int i = 0; i < count; i++) {
+        ChunkColumns cols;
+        PackedColumns packed;
+        sampleChunkColumns(coords[i].first, coords[i].second, cols);
+        packedBytes += packChunkColumns(cols, packed) ? packedColumnsBytes(packed) : sizeof(cols);
+    }
+
+    OcclusionResult occlusion = runOcclusion(coords, centerX, centerZ, radius);
+
+    unsigned long long floats = 0, translucent = 0;
+    for(int i = 0; i < count; i++) {
+        floats += meshFloats[i];
+        translucent += translucentFloats[i];
+    }
+    unsigned long long vertices = floats / 5;
+    double total = populate.seconds + apply.seconds + mesh.seconds;
+
+    std::printf("seed %u, radius %d (%d chunks), %d thread%s\n",
+                seed, radius, count, threads, threads == 1 ? "" : "s");
+    printPhase("populate", populate, count);
+    printPhase("apply", apply, count);
+    printPhase("mesh", mesh, count);
+    printPhase("total", PhaseResult{total, populate.allocs + apply.allocs + mesh.allocs,
+                                    populate.allocBytes + apply.allocBytes + mesh.allocBytes}, count);
+    std::printf("vertices   %llu (%llu translucent, %.1f M vertices/s meshing)\n",
+                vertices, translucent / 5, vertices / (mesh.seconds > 0 ? mesh.seconds : 1e-9) / 1e6);
+    std::printf("mesh size  %.1f KiB/chunk\n", (double)floats * sizeof(float) / count / 1024.0);
+    std::printf("columns    %zu bytes/chunk, %.0f packed (%.1fx)\n", sizeof(ChunkColumns),
+                (double)packedBytes / count, (double)sizeof(ChunkColumns) * count / packedBytes);
+    std::printf("world      %zu extra blocks, %zu water cells\n", extraBlocks.size(), waterLevels.size());
+    std::printf("reference  %d of %d chunks differ from the block-by-block face count (%lld faces)\n",
+                mismatched.load(), count, facesOff.load());
+    std::printf("occlusion  %.1f%% of sections in the frustum, %.1f%% of those hidden by terrain, "
+                "%zu occluders, %.2f ms/view\n",
+                100.0 * occlusion.inFrustum / (occlusion.tested ? occlusion.tested : 1),
+                100.0 * occlusion.hidden / (occlusion.inFrustum ? occlusion.inFrustum : 1),
+                occlusion.occluders, occlusion.workerMs / OCCLUSION_VIEWS);
+    return 0;
+}
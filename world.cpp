@@ -4,10 +4,70 @@
 #include <fstream>
 
 // Define extraBlocks (for terrain overrides)
-std::unordered_map<std::tuple<int,int,int>, BlockType, TupleHash> extraBlocks;
+FlatMap<BlockType> extraBlocks;
 
 // Define waterLevels (maps (x,y,z) to water level 1–8)
-std::unordered_map<std::tuple<int,int,int>, int, TupleHash> waterLevels;
+FlatMap<int> waterLevels;
+
+// Entries per (cx, sy, cz) section, and the highest edited section per chunk.
+static FlatMap<int> s_sectionEdits;
+static FlatMap<int> s_topEditedSection;
+
+static void countEdit(int x, int y, int z, int delta) {
+    int cx, cz;
+    getChunkCoords(x, z, cx, cz);
+    int sy = getSectionY(y);
+    uint64_t key = packBlockKey(cx, sy, cz);
+    int &count = s_sectionEdits[key];
+    count += delta;
+    if(count <= 0) {
+        s_sectionEdits.erase(key);
+        return;
+    }
+    auto top = s_topEditedSection.find(packChunkKey(cx, cz));
+    if(top == s_topEditedSection.end())
+        s_topEditedSection[packChunkKey(cx, cz)] = sy;
+    else if(sy > top->second)
+        top->second = sy;
+}
+
+void setExtraBlock(int x, int y, int z, BlockType type) {
+    auto result = extraBlocks.insert({packBlockKey(x, y, z), type});
+    if(result.second)
+        countEdit(x, y, z, 1);
+    else
+        result.first->second = type;
+}
+
+void removeExtraBlock(int x, int y, int z) {
+    if(extraBlocks.erase(packBlockKey(x, y, z)))
+        countEdit(x, y, z, -1);
+}
+
+void setWaterLevel(int x, int y, int z, int level) {
+    auto result = waterLevels.insert({packBlockKey(x, y, z), level});
+    if(result.second)
+        countEdit(x, y, z, 1);
+    else
+        result.first->second = level;
+}
+
+void clearWorldEdits() {
+    extraBlocks.clear();
+    waterLevels.clear();
+    s_sectionEdits.clear();
+    s_topEditedSection.clear();
+}
+
+int sectionEditCount(int cx, int sy, int cz) {
+    auto it = s_sectionEdits.find(packBlockKey(cx, sy, cz));
+    return it == s_sectionEdits.end() ? 0 : it->second;
+}
+
+int topEditedSection(int cx, int cz) {
+    auto it = s_topEditedSection.find(packChunkKey(cx, cz));
+    return it == s_topEditedSection.end() ? -1 : it->second;
+}
 
 bool loadWorld(const char* filename,
                int &outSeed,
@@ -25,12 +85,12 @@ bool loadWorld(const char* filename,
     setNoiseSeed(outSeed);
     int count;
     in >> count;
-    extraBlocks.clear();
+    clearWorldEdits();
     for(int i = 0; i < count; i++)
     {
         int bx, by, bz, typeInt;
         in >> bx >> by >> bz >> typeInt;
-        extraBlocks[{bx,by,bz}] = (BlockType)typeInt;
+        setExtraBlock(bx, by, bz, (BlockType)typeInt);
     }
     in.close();
     std::cout << "[loadWorld] Loaded seed=" << outSeed 
@@ -56,11 +116,9 @@ bool saveWorld(const char* filename,
     out << count << "\n";
     for(const auto &kv : extraBlocks)
     {
-        const auto &pos = kv.first;
         BlockType bType = kv.second;
-        int bx = std::get<0>(pos);
-        int by = std::get<1>(pos);
-        int bz = std::get<2>(pos);
+        int bx, by, bz;
+        unpackBlockKey(kv.first, bx, by, bz);
         out << bx << " " << by << " " << bz << " " << (int)bType << "\n";
     }
     out.close();
@@ -2,25 +2,46 @@
 #define WORLD_H
 
 #include <string>
-#include <unordered_map>
-#include <tuple>
 #include "cube.h"
-#include "globals.h"
+#include "coords.h"
+#include "flatmap.h"
+
+// Both maps are keyed by packBlockKey(x, y, z).
 
 // extraBlocks is used for terrain overrides (trees, modifications, etc.)
-extern std::unordered_map<std::tuple<int, int, int>, BlockType, TupleHash> extraBlocks;
+extern FlatMap<BlockType> extraBlocks;
 
 // waterLevels stores water at a given (x,y,z) with a water level (1–8),
 // where 8 indicates a source cell.
-extern std::unordered_map<std::tuple<int, int, int>, int, TupleHash> waterLevels;
+extern FlatMap<int> waterLevels;
+
+// Write extraBlocks/waterLevels through these so the per-section edit
+// index below stays in sync. Reading the maps directly is fine.
+void setExtraBlock(int x, int y, int z, BlockType type);
+void removeExtraBlock(int x, int y, int z);
+void setWaterLevel(int x, int y, int z, int level);
+void clearWorldEdits();
+
+// Number of extraBlocks and waterLevels entries inside the 16x16x16
+// section (cx, sy, cz). Sections with none are pure terrain, so the mesher
+// can skip the map lookups for them.
+int sectionEditCount(int cx, int sy, int cz);
+
+// Highest section of chunk (cx, cz) that has ever held an edit, or -1.
+// Never lowered when edits are removed, so it is an upper bound.
+int topEditedSection(int cx, int cz);
 
 bool loadWorld(const char* filename, int &outSeed,
                float &outPlayerX, float &outPlayerY, float &outPlayerZ);
 bool saveWorld(const char* filename, int seed,
                float playerX, float playerY, float playerZ);
 
-// Returns true if the block at the given coordinates is solid.
+// Block queries answered from the block registry (blocks.h): whether the
+// block at the given coordinates has collision, stops the crosshair
+// raycast, or hides the faces of blocks next to it.
 bool isSolidBlock(int bx, int by, int bz);
+bool isTargetBlock(int bx, int by, int bz);
+bool isOccludingBlock(int bx, int by, int bz);
 
 #endif
 